@@ -0,0 +1,240 @@
+//Client processing pipeline benchmark.
+//Connects many client Engines to one server Engine through the in-process loopback
+//transport and drives their moveEvent at a fixed rate (or as fast as possible), so the
+//client side - doTrySendEvents, doProcessIncomingNotifications, the plot double buffer -
+//runs at rates no network can deliver. Every move is a latency probe.
+//Prints one key=value line.
+
+#include "benchmark/bubbles_loopback.hpp"
+
+#include "solid/frame/manager.hpp"
+#include "solid/frame/scheduler.hpp"
+#include "solid/frame/service.hpp"
+#include "solid/frame/reactor.hpp"
+
+#include "boost/program_options.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace solid;
+using namespace bubbles;
+
+namespace{
+
+using SteadyClockT = std::chrono::steady_clock;
+using SchedulerT = frame::Scheduler<frame::Reactor>;
+using EnginePointerT = client::Engine::PointerT;
+using ConnectionPointerT = std::unique_ptr<loopback::Connection>;
+
+struct Parameters{
+    Parameters(){}
+
+    size_t      client_count;
+    size_t      room_count;
+    size_t      rate;
+    size_t      warmup_seconds;
+    size_t      duration_seconds;
+    size_t      thread_count;
+    size_t      max_pending_count;
+    size_t      send_window_size;
+    size_t      send_batch_interval_msec;
+};
+
+bool parseArguments(Parameters &_par, int argc, char *argv[]);
+
+//walks every client along its own line through the canvas - cheap and deterministic
+void move_all(vector<EnginePointerT> &_rengines, const size_t _step){
+    for(size_t i = 0; i < _rengines.size(); ++i){
+        const int x = static_cast<int>((i * 37 + _step * 5) % 7680);
+        const int y = static_cast<int>((i * 91 + _step * 3) % 7680);
+
+        _rengines[i]->moveEvent(x, y);
+    }
+}
+
+void sum_statistics(vector<EnginePointerT> &_rengines, client::EngineStatistics &_rtotal){
+    _rtotal = client::EngineStatistics();
+    for(auto &rengine_ptr: _rengines){
+        client::EngineStatistics statistics;
+
+        rengine_ptr->statistics(statistics);
+
+        _rtotal.sent_message_count += statistics.sent_message_count;
+        _rtotal.sent_event_count += statistics.sent_event_count;
+        _rtotal.received_message_count += statistics.received_message_count;
+        _rtotal.received_event_count += statistics.received_event_count;
+        _rtotal.dropped_event_count += statistics.dropped_event_count;
+        _rtotal.connection_stop_count += statistics.connection_stop_count;
+    }
+}
+
+}//namespace
+
+int main(int argc, char *argv[]){
+    Parameters params;
+
+    if(parseArguments(params, argc, argv)) return 0;
+
+    if(params.client_count == 0 or params.room_count == 0){
+        cout<<"error: no clients"<<endl;
+        return 1;
+    }
+
+    SchedulerT                  scheduler;
+    frame::Manager              manager;
+    frame::ServiceT             service{manager};
+    ErrorConditionT             err;
+    server::EngineConfiguration server_cfg;
+    client::EngineConfiguration client_cfg;
+    std::atomic<uint64_t>       update_count(0);
+
+    server_cfg.connection_max_pending_count = params.max_pending_count;
+
+    client_cfg.probe = true;
+    client_cfg.move_min_interval_msec = 0;//the rate is set by the driver below
+    client_cfg.send_window_size = params.send_window_size;
+    client_cfg.send_batch_interval_msec = params.send_batch_interval_msec;
+
+    err = scheduler.start(params.thread_count ? params.thread_count : std::thread::hardware_concurrency());
+
+    if(err){
+        cout<<"Error starting scheduler: "<<err.message()<<endl;
+        return 1;
+    }
+
+    //the connections and the engines must outlive the loopback server - it completes the pending work on destruction
+    vector<ConnectionPointerT>                  connections;
+    vector<EnginePointerT>                      engines;
+    std::unique_ptr<loopback::Server>           server_ptr(new loopback::Server(server_cfg));
+
+    for(size_t i = 0; i < params.client_count; ++i){
+        connections.emplace_back(new loopback::Connection(*server_ptr));
+        engines.push_back(client::Engine::create(service, *connections.back(), client_cfg));
+
+        EnginePointerT &rengine_ptr = engines.back();
+
+        rengine_ptr->setExitFunction([](){});
+        rengine_ptr->setGuiUpdateFunction([&update_count](){++update_count;});
+        rengine_ptr->setAutoUpdateFunction([](){});
+
+        err = rengine_ptr->start(scheduler, "loopback", "bench" + std::to_string(i % params.room_count));
+
+        if(err){
+            cout<<"Error starting engine: "<<err.message()<<endl;
+            return 1;
+        }
+    }
+
+    const std::chrono::microseconds period(params.rate ? 1000000 / params.rate : 0);
+    SteadyClockT::time_point        next_time = SteadyClockT::now();
+    size_t                          step = 0;
+
+    auto drive = [&](const size_t _seconds){
+        const SteadyClockT::time_point end_time = SteadyClockT::now() + std::chrono::seconds(_seconds);
+
+        while(SteadyClockT::now() < end_time){
+            move_all(engines, step++);
+            if(period.count()){
+                next_time += period;
+                std::this_thread::sleep_until(next_time);
+            }
+        }
+    };
+
+    //warm up - registrations and join snapshots are not measured
+    drive(params.warmup_seconds);
+
+    client::EngineStatistics    start_statistics;
+    LatencyHistogram            latency;
+
+    sum_statistics(engines, start_statistics);
+    for(auto &rengine_ptr: engines){
+        rengine_ptr->collectLatency(latency);
+    }
+    latency.clear();
+
+    const uint64_t              start_update_count = update_count;
+    const uint64_t              start_call_count = server_ptr->callCount();
+    const SteadyClockT::time_point start_time = SteadyClockT::now();
+
+    drive(params.duration_seconds);
+
+    const double                seconds = std::chrono::duration<double>(SteadyClockT::now() - start_time).count();
+    client::EngineStatistics    end_statistics;
+
+    sum_statistics(engines, end_statistics);
+    for(auto &rengine_ptr: engines){
+        rengine_ptr->collectLatency(latency);
+    }
+
+    const uint64_t              updates = update_count - start_update_count;
+    const uint64_t              server_calls = server_ptr->callCount() - start_call_count;
+
+    cout<<"client_pipeline"
+        <<" clients="<<params.client_count
+        <<" rooms="<<params.room_count
+        <<" rate="<<params.rate
+        <<" seconds="<<seconds
+        <<" sent_events_per_s="<<static_cast<uint64_t>((end_statistics.sent_event_count - start_statistics.sent_event_count) / seconds)
+        <<" sent_messages_per_s="<<static_cast<uint64_t>((end_statistics.sent_message_count - start_statistics.sent_message_count) / seconds)
+        <<" received_events_per_s="<<static_cast<uint64_t>((end_statistics.received_event_count - start_statistics.received_event_count) / seconds)
+        <<" received_messages_per_s="<<static_cast<uint64_t>((end_statistics.received_message_count - start_statistics.received_message_count) / seconds)
+        <<" updates_per_s="<<static_cast<uint64_t>(updates / seconds)
+        <<" server_calls_per_s="<<static_cast<uint64_t>(server_calls / seconds)
+        <<" dropped_events="<<(end_statistics.dropped_event_count - start_statistics.dropped_event_count)
+        <<" samples="<<latency.count()
+        <<" p50_us="<<latency.percentile(50)
+        <<" p99_us="<<latency.percentile(99)
+        <<" p999_us="<<latency.percentile(99.9)
+        <<" max_us="<<latency.max()
+        <<endl;
+
+    manager.stop();
+    scheduler.stop();
+    server_ptr.reset();
+    engines.clear();
+    connections.clear();
+    return 0;
+}
+
+namespace{
+
+bool parseArguments(Parameters &_par, int argc, char *argv[]){
+    using namespace boost::program_options;
+    try{
+        options_description desc("Bubbles client pipeline benchmark");
+        desc.add_options()
+            ("help,h", "List program options")
+            ("clients,c", value<size_t>(&_par.client_count)->default_value(100), "Client engines")
+            ("rooms,r", value<size_t>(&_par.room_count)->default_value(1), "Rooms the clients are spread over")
+            ("rate", value<size_t>(&_par.rate)->default_value(60), "Moves per second per client - 0 for as fast as possible")
+            ("warmup", value<size_t>(&_par.warmup_seconds)->default_value(1), "Seconds before measuring")
+            ("duration,d", value<size_t>(&_par.duration_seconds)->default_value(5), "Seconds measured")
+            ("threads,t", value<size_t>(&_par.thread_count)->default_value(0), "Client engine threads - 0 for one per core")
+            ("max-pending", value<size_t>(&_par.max_pending_count)->default_value(server::EngineConfiguration().connection_max_pending_count), "Server EngineConfiguration::connection_max_pending_count")
+            ("send-window", value<size_t>(&_par.send_window_size)->default_value(client::EngineConfiguration().send_window_size), "Client EngineConfiguration::send_window_size")
+            ("send-batch-msec", value<size_t>(&_par.send_batch_interval_msec)->default_value(client::EngineConfiguration().send_batch_interval_msec), "Client EngineConfiguration::send_batch_interval_msec")
+        ;
+        variables_map vm;
+        store(parse_command_line(argc, argv, desc), vm);
+        notify(vm);
+        if (vm.count("help")) {
+            cout << desc << "\n";
+            return true;
+        }
+        return false;
+    }catch(exception& e){
+        cout << e.what() << "\n";
+        return true;
+    }
+}
+
+}//namespace
@@ -0,0 +1,579 @@
+//Serialization and compression micro-benchmark for protocol/bubbles_messages.hpp.
+//Every message registered by protocol_setup is serialized and deserialized through
+//ProtocolT with representative payloads. The serialized stream is cut into packets
+//and every packet is compressed with Snappy, the way mpipc::snappy compresses a packet.
+//Prints one key=value line per payload.
+//Besides the representative payloads, EventsNotification is sent with 0, N and N+1
+//stubs and events - N the inline capacity of its small vectors - and once recycled.
+//Every EventsNotification is also serialized through the std containers the small
+//vectors replaced (std::vector and std::deque) - the bytes must be the same.
+//The decoded messages are compared field by field with the source - exits with 1
+//on a mismatch or on a serialization error.
+
+#include "protocol/bubbles_messages.hpp"
+
+#include "solid/frame/mpipc/mpipcconfiguration.hpp"
+#include "solid/frame/mpipc/mpipccontext.hpp"
+
+#include "snappy.h"
+
+#include "boost/program_options.hpp"
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+using namespace std;
+using namespace solid;
+using namespace bubbles;
+
+namespace solid{namespace frame{namespace mpipc{
+//the same entry the mpipc protocol tests use to get a context without a connection
+struct TestEntryway{
+    static ConnectionContext& createContext(){
+        Connection  &rcon = *static_cast<Connection*>(nullptr);
+        Service     &rsvc = *static_cast<Service*>(nullptr);
+        static ConnectionContext conctx(rsvc, rcon);
+        return conctx;
+    }
+};
+}}}
+
+namespace{
+
+using SteadyClockT = std::chrono::steady_clock;
+using PacketVectorT = vector<string>;
+using MessageFactoryT = std::function<frame::mpipc::MessagePointerT()>;
+
+struct Parameters{
+    Parameters(){}
+
+    size_t  iteration_count;
+    size_t  packet_size;
+    size_t  text_size;
+};
+
+bool parseArguments(Parameters &_par, int argc, char *argv[]);
+
+struct NoopSetup{
+    template <typename T>
+    void operator()(ProtocolT& _rprotocol, TypeToType<T> _t2t, const ProtocolT::TypeIdT& _rtid){
+        auto lambda = [](
+            frame::mpipc::ConnectionContext &/*_rctx*/,
+            std::shared_ptr<T> &/*_rsent_msg_ptr*/,
+            std::shared_ptr<T> &/*_rrecv_msg_ptr*/,
+            ErrorConditionT const &/*_rerror*/
+        ){};
+        _rprotocol.registerMessage<T>(lambda, _rtid);
+    }
+};
+
+//EventStub and EventsNotification with the std containers they had before the small
+//vectors - the reference for the wire format
+struct StdEventStub{
+    bubbles::Event          event;
+    ConnectionId            connection_id;
+    uint32_t                sender_rgb_color;
+    std::string             text;
+    vector<bubbles::Event>  events;
+
+    StdEventStub():sender_rgb_color(0){}
+
+    SOLID_PROTOCOL_V2(_s, _rthis, _rctx, _name){
+        _s.add(_rthis.event, _rctx, "event");
+        _s.add(_rthis.connection_id, _rctx, "connection_id");
+        _s.add(_rthis.sender_rgb_color, _rctx, "sender_rgb_color");
+        _s.add(_rthis.text, _rctx, "text");
+        _s.add(_rthis.events, _rctx, "events");
+    }
+};
+
+struct StdEventsNotification: frame::mpipc::Message{
+    StdEventStub            event_stub;
+    deque<StdEventStub>     event_stubs;
+
+    SOLID_PROTOCOL_V2(_s, _rthis, _rctx, _name){
+        const size_t limit_container = _s.limits().container();
+        const size_t limit_string = _s.limits().string();
+
+        _s.limitContainer(1024, _name);
+        _s.limitString(1024, _name);
+        _s.add(_rthis.event_stub, _rctx, "event_stub").add(_rthis.event_stubs, _rctx, "event_stubs");
+        _s.limitContainer(limit_container, _name);
+        _s.limitString(limit_string, _name);
+    }
+};
+
+//the type id protocol_setup gives EventsNotification
+const ProtocolT::TypeIdT events_notification_type_id = 3;
+
+StdEventStub make_std_event_stub(const EventStub &_revent_stub){
+    StdEventStub std_event_stub;
+
+    std_event_stub.event = _revent_stub.event;
+    std_event_stub.connection_id = _revent_stub.connection_id;
+    std_event_stub.sender_rgb_color = _revent_stub.sender_rgb_color;
+    std_event_stub.text = _revent_stub.text;
+    std_event_stub.events.assign(_revent_stub.events.begin(), _revent_stub.events.end());
+    return std_event_stub;
+}
+
+frame::mpipc::MessagePointerT make_std_events_notification(const EventsNotification &_rmsg){
+    auto msg_ptr = std::make_shared<StdEventsNotification>();
+
+    msg_ptr->event_stub = make_std_event_stub(_rmsg.event_stub);
+    for(const auto &revent_stub: _rmsg.event_stubs){
+        msg_ptr->event_stubs.push_back(make_std_event_stub(revent_stub));
+    }
+    return frame::mpipc::MessagePointerT(std::move(msg_ptr));
+}
+
+struct Payload{
+    string          name;
+    MessageFactoryT factory;
+};
+
+using PayloadVectorT = vector<Payload>;
+
+Event make_move(const int _i){
+    Event event(Event::PointerMove);
+    event.x = 100 + _i * 3;
+    event.y = 200 - _i * 2;
+    event.diff_time_msec = 16;
+    return event;
+}
+
+//_event_count extra samples on the stub and on each of the _stub_count snapshot stubs
+void fill_events(EventsNotification &_rmsg, const size_t _stub_count, const size_t _event_count){
+    _rmsg.event_stub.event = make_move(0);
+    _rmsg.event_stub.sender_rgb_color = 0xff8000;
+    for(size_t i = 1; i <= _event_count; ++i){
+        _rmsg.event_stub.events.push_back(make_move(i));
+    }
+    for(size_t i = 1; i <= _stub_count; ++i){
+        _rmsg.event_stubs.push_back(EventStub{});
+        _rmsg.event_stubs.back().event = make_move(i);
+        _rmsg.event_stubs.back().sender_rgb_color = i * 2654435761u;
+        for(size_t j = 1; j <= _event_count; ++j){
+            _rmsg.event_stubs.back().events.push_back(make_move(i + j));
+        }
+    }
+}
+
+PayloadVectorT make_payloads(const Parameters &_rpar){
+    PayloadVectorT  payloads;
+    const size_t    text_size = _rpar.text_size;
+
+    payloads.push_back(Payload{"register_request", [](){
+        return frame::mpipc::MessagePointerT(std::make_shared<RegisterRequest>("bubbles-test-room", 0xff8000));
+    }});
+    payloads.push_back(Payload{"register_response", [](){
+        return frame::mpipc::MessagePointerT(std::make_shared<RegisterResponse>(RegisterRequest(), 0xff8000));
+    }});
+    payloads.push_back(Payload{"events_single_move", [](){
+        auto msg_ptr = std::make_shared<EventsNotification>();
+        msg_ptr->event_stub.event = make_move(0);
+        msg_ptr->event_stub.sender_rgb_color = 0xff8000;
+        return frame::mpipc::MessagePointerT(std::move(msg_ptr));
+    }});
+    payloads.push_back(Payload{"events_trajectory_1000", [](){
+        auto msg_ptr = std::make_shared<EventsNotification>();
+        msg_ptr->event_stub.event = make_move(0);
+        msg_ptr->event_stub.sender_rgb_color = 0xff8000;
+        for(int i = 1; i <= 1000; ++i){
+            msg_ptr->event_stub.events.push_back(make_move(i));
+        }
+        return frame::mpipc::MessagePointerT(std::move(msg_ptr));
+    }});
+    payloads.push_back(Payload{"events_join_snapshot_1024", [](){
+        auto msg_ptr = std::make_shared<EventsNotification>();
+        msg_ptr->event_stub.event = make_move(0);
+        msg_ptr->event_stub.sender_rgb_color = 1;
+        for(uint32_t i = 1; i < EventsNotification::containerLimit(); ++i){
+            msg_ptr->event_stubs.push_back(EventStub{});
+            msg_ptr->event_stubs.back().event = make_move(i);
+            msg_ptr->event_stubs.back().sender_rgb_color = i * 2654435761u;
+        }
+        return frame::mpipc::MessagePointerT(std::move(msg_ptr));
+    }});
+    payloads.push_back(Payload{"events_long_text", [text_size](){
+        auto msg_ptr = std::make_shared<EventsNotification>();
+        msg_ptr->event_stub.event = make_move(0);
+        msg_ptr->event_stub.sender_rgb_color = 0xff8000;
+        for(size_t i = 0; msg_ptr->event_stub.text.size() < text_size; ++i){
+            msg_ptr->event_stub.text += "bubble ";
+            msg_ptr->event_stub.text += std::to_string(i);
+            msg_ptr->event_stub.text += ' ';
+        }
+        msg_ptr->event_stub.text.resize(text_size);
+        return frame::mpipc::MessagePointerT(std::move(msg_ptr));
+    }});
+    payloads.push_back(Payload{"events_request", [](){
+        auto msg_ptr = std::make_shared<EventsNotificationRequest>();
+        msg_ptr->event_stub.event = make_move(0);
+        msg_ptr->event_stub.sender_rgb_color = 0xff8000;
+        for(int i = 1; i <= 3; ++i){
+            msg_ptr->event_stub.events.push_back(make_move(i));
+        }
+        return frame::mpipc::MessagePointerT(std::move(msg_ptr));
+    }});
+    //the inline capacity boundaries of the small vectors - 0, N and N+1 elements
+    const size_t inline_stub_count = EventsNotification::EventStubVectorT::inlineCapacity();
+    const size_t inline_event_count = EventStub::EventVectorT::inlineCapacity();
+
+    for(const size_t stub_count: {size_t(0), inline_stub_count, inline_stub_count + 1}){
+        for(const size_t event_count: {size_t(0), inline_event_count, inline_event_count + 1}){
+            payloads.push_back(Payload{"events_stubs_" + std::to_string(stub_count) + "_events_" + std::to_string(event_count), [stub_count, event_count](){
+                auto msg_ptr = std::make_shared<EventsNotification>();
+                fill_events(*msg_ptr, stub_count, event_count);
+                return frame::mpipc::MessagePointerT(std::move(msg_ptr));
+            }});
+        }
+    }
+    //a pooled message - reset after a join snapshot, then reused for a small one
+    payloads.push_back(Payload{"events_recycled", [inline_stub_count, inline_event_count](){
+        auto msg_ptr = std::make_shared<EventsNotification>();
+        fill_events(*msg_ptr, EventsNotification::containerLimit() - 1, inline_event_count + 1);
+        msg_ptr->reset();
+        fill_events(*msg_ptr, inline_stub_count + 1, inline_event_count);
+        return frame::mpipc::MessagePointerT(std::move(msg_ptr));
+    }});
+    payloads.push_back(Payload{"events_response", [](){
+        return frame::mpipc::MessagePointerT(std::make_shared<EventsNotificationResponse>(EventsNotificationRequest(), 0, 10, 0));
+    }});
+    payloads.push_back(Payload{"suspend_notification", [](){
+        return frame::mpipc::MessagePointerT(std::make_shared<SuspendNotification>(true));
+    }});
+    return payloads;
+}
+
+bool equal(const bubbles::Event &_rsent, const bubbles::Event &_rrecv){
+    return _rsent.type == _rrecv.type and _rsent.flags == _rrecv.flags and
+        _rsent.x == _rrecv.x and _rsent.y == _rrecv.y and
+        _rsent.data == _rrecv.data and _rsent.diff_time_msec == _rrecv.diff_time_msec;
+}
+
+bool equal(const ConnectionId &_rsent, const ConnectionId &_rrecv){
+    return _rsent.server_idx == _rrecv.server_idx and _rsent.server_unq == _rrecv.server_unq and
+        _rsent.connection_idx == _rrecv.connection_idx and _rsent.connection_unq == _rrecv.connection_unq;
+}
+
+bool equal(const EventStub &_rsent, const EventStub &_rrecv);
+
+template <class Vec>
+bool equal_all(const Vec &_rsent, const Vec &_rrecv){
+    if(_rsent.size() != _rrecv.size()){
+        return false;
+    }
+    for(size_t i = 0; i < _rsent.size(); ++i){
+        if(!equal(_rsent[i], _rrecv[i])){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool equal(const EventStub &_rsent, const EventStub &_rrecv){
+    return equal(_rsent.event, _rrecv.event) and equal(_rsent.connection_id, _rrecv.connection_id) and
+        _rsent.sender_rgb_color == _rrecv.sender_rgb_color and _rsent.text == _rrecv.text and
+        equal_all(_rsent.events, _rrecv.events);
+}
+
+//field by field comparison of a decoded message with its source
+bool equal(const frame::mpipc::MessagePointerT &_rsent_ptr, const frame::mpipc::MessagePointerT &_rrecv_ptr){
+    if(!_rrecv_ptr or typeid(*_rsent_ptr) != typeid(*_rrecv_ptr)){
+        return false;
+    }
+    if(const RegisterRequest *psent = dynamic_cast<const RegisterRequest*>(_rsent_ptr.get())){
+        const RegisterRequest &rrecv = static_cast<const RegisterRequest&>(*_rrecv_ptr);
+        return psent->room_name == rrecv.room_name and psent->rgb_color == rrecv.rgb_color;
+    }
+    if(const RegisterResponse *psent = dynamic_cast<const RegisterResponse*>(_rsent_ptr.get())){
+        const RegisterResponse &rrecv = static_cast<const RegisterResponse&>(*_rrecv_ptr);
+        return psent->error == rrecv.error and psent->rgb_color == rrecv.rgb_color and psent->message == rrecv.message;
+    }
+    if(const EventsNotification *psent = dynamic_cast<const EventsNotification*>(_rsent_ptr.get())){
+        const EventsNotification &rrecv = static_cast<const EventsNotification&>(*_rrecv_ptr);
+        return equal(psent->event_stub, rrecv.event_stub) and equal_all(psent->event_stubs, rrecv.event_stubs);
+    }
+    if(const EventsNotificationResponse *psent = dynamic_cast<const EventsNotificationResponse*>(_rsent_ptr.get())){
+        const EventsNotificationResponse &rrecv = static_cast<const EventsNotificationResponse&>(*_rrecv_ptr);
+        return psent->error == rrecv.error and psent->success_count == rrecv.success_count and
+            psent->fail_count == rrecv.fail_count and psent->message == rrecv.message;
+    }
+    if(const SuspendNotification *psent = dynamic_cast<const SuspendNotification*>(_rsent_ptr.get())){
+        const SuspendNotification &rrecv = static_cast<const SuspendNotification&>(*_rrecv_ptr);
+        return psent->suspend == rrecv.suspend;
+    }
+    cout<<"error: no comparison for "<<typeid(*_rsent_ptr).name()<<endl;
+    return false;
+}
+
+template <class Ser>
+bool serialize(
+    Ser &_rser, frame::mpipc::ConnectionContext &_rctx,
+    frame::mpipc::MessagePointerT &_rmsg_ptr, const size_t _type_idx,
+    const size_t _packet_size, PacketVectorT &_rpackets
+){
+    size_t packet_count = 0;
+
+    _rser.push(_rmsg_ptr, _type_idx);
+
+    while(!_rser.empty()){
+        if(_rpackets.size() == packet_count){
+            _rpackets.push_back(string());
+        }
+        string &rpacket = _rpackets[packet_count];
+        rpacket.resize(_packet_size);
+
+        const long rv = _rser.run(_rctx, &rpacket[0], rpacket.size());
+
+        if(rv < 0){
+            cout<<"error: serialization: "<<_rser.error().message()<<endl;
+            _rpackets.resize(packet_count);
+            return false;
+        }
+        rpacket.resize(rv);
+        ++packet_count;
+    }
+    _rpackets.resize(packet_count);
+    return true;
+}
+
+//returns an empty pointer on error
+template <class Des>
+frame::mpipc::MessagePointerT deserialize(
+    Des &_rdes, frame::mpipc::ConnectionContext &_rctx,
+    const PacketVectorT &_rpackets
+){
+    frame::mpipc::MessagePointerT msg_ptr;
+
+    _rdes.push(msg_ptr);
+
+    for(const auto &rpacket: _rpackets){
+        const char *pdata = rpacket.data();
+        size_t      size = rpacket.size();
+        while(size){
+            const long rv = _rdes.run(_rctx, pdata, size);
+            if(rv <= 0){
+                if(rv < 0){
+                    cout<<"error: deserialization: "<<_rdes.error().message()<<endl;
+                    msg_ptr.reset();
+                }
+                return msg_ptr;
+            }
+            pdata += rv;
+            size -= rv;
+        }
+    }
+    return msg_ptr;
+}
+
+size_t compress(const PacketVectorT &_rpackets, PacketVectorT &_rcompressed){
+    size_t total = 0;
+
+    _rcompressed.resize(_rpackets.size());
+
+    for(size_t i = 0; i < _rpackets.size(); ++i){
+        size_t  len = 0;
+        string  &rout = _rcompressed[i];
+
+        rout.resize(snappy::MaxCompressedLength(_rpackets[i].size()));
+        snappy::RawCompress(_rpackets[i].data(), _rpackets[i].size(), &rout[0], &len);
+        rout.resize(len);
+        total += len;
+    }
+    return total;
+}
+
+void uncompress(const PacketVectorT &_rcompressed, PacketVectorT &_rpackets){
+    _rpackets.resize(_rcompressed.size());
+
+    for(size_t i = 0; i < _rcompressed.size(); ++i){
+        size_t  len = 0;
+        string  &rout = _rpackets[i];
+
+        snappy::GetUncompressedLength(_rcompressed[i].data(), _rcompressed[i].size(), &len);
+        rout.resize(len);
+        snappy::RawUncompress(_rcompressed[i].data(), _rcompressed[i].size(), &rout[0]);
+    }
+}
+
+uint64_t nsec_per(const SteadyClockT::duration &_duration, const size_t _count){
+    return _count ? std::chrono::duration_cast<std::chrono::nanoseconds>(_duration).count() / _count : 0;
+}
+
+//_rpackets - the serialized EventsNotification; compared with the one through _rstd_proto
+bool same_wire_format(
+    const Parameters &_rpar, ProtocolT &_rstd_proto, const EventsNotification &_rmsg, const PacketVectorT &_rpackets
+){
+    frame::mpipc::ConnectionContext &rctx = frame::mpipc::TestEntryway::createContext();
+    frame::mpipc::WriterConfiguration   writer_cfg;
+    auto                                ser_ptr = _rstd_proto.createSerializer(writer_cfg);
+    frame::mpipc::MessagePointerT       std_msg_ptr = make_std_events_notification(_rmsg);
+    PacketVectorT                       std_packets;
+    string                              bytes;
+    string                              std_bytes;
+
+    if(!serialize(*ser_ptr, rctx, std_msg_ptr, _rstd_proto.typeIndex(std_msg_ptr.get()), _rpar.packet_size, std_packets)){
+        return false;
+    }
+    for(const auto &rpacket: _rpackets){
+        bytes += rpacket;
+    }
+    for(const auto &rpacket: std_packets){
+        std_bytes += rpacket;
+    }
+    return bytes == std_bytes;
+}
+
+//returns false when a decoded message differs from its source or on error
+bool run(const Parameters &_rpar, ProtocolT &_rproto, ProtocolT &_rstd_proto, const Payload &_rpayload){
+    frame::mpipc::ConnectionContext &rctx = frame::mpipc::TestEntryway::createContext();
+    frame::mpipc::WriterConfiguration   writer_cfg;
+    frame::mpipc::ReaderConfiguration   reader_cfg;
+    auto                                ser_ptr = _rproto.createSerializer(writer_cfg);
+    auto                                des_ptr = _rproto.createDeserializer(reader_cfg);
+    PacketVectorT                       packets;
+    PacketVectorT                       compressed_packets;
+    PacketVectorT                       uncompressed_packets;
+    frame::mpipc::MessagePointerT       source_msg_ptr = _rpayload.factory();
+    frame::mpipc::MessagePointerT       recv_msg_ptr;
+    size_t                              byte_count = 0;
+    size_t                              compressed_byte_count = 0;
+    bool                                ok = true;
+
+    //serialize - a new message every time, like the engines do
+    SteadyClockT::duration serialize_duration(0);
+    for(size_t i = 0; i < _rpar.iteration_count and ok; ++i){
+        frame::mpipc::MessagePointerT   msg_ptr = _rpayload.factory();
+        const size_t                    type_idx = _rproto.typeIndex(msg_ptr.get());
+        const auto                      start_time = SteadyClockT::now();
+
+        ok = serialize(*ser_ptr, rctx, msg_ptr, type_idx, _rpar.packet_size, packets);
+        serialize_duration += SteadyClockT::now() - start_time;
+    }
+    if(!ok){
+        cout<<"error: message="<<_rpayload.name<<" serialization failed"<<endl;
+        return false;
+    }
+
+    for(const auto &rpacket: packets){
+        byte_count += rpacket.size();
+    }
+
+    if(
+        typeid(*source_msg_ptr) == typeid(EventsNotification) and
+        !same_wire_format(_rpar, _rstd_proto, static_cast<const EventsNotification&>(*source_msg_ptr), packets)
+    ){
+        cout<<"error: message="<<_rpayload.name<<" serialized differently than with the std containers"<<endl;
+        return false;
+    }
+
+    //deserialize
+    const auto start_deserialize = SteadyClockT::now();
+    for(size_t i = 0; i < _rpar.iteration_count; ++i){
+        recv_msg_ptr = deserialize(*des_ptr, rctx, packets);
+    }
+    const auto deserialize_duration = SteadyClockT::now() - start_deserialize;
+
+    if(!equal(source_msg_ptr, recv_msg_ptr)){
+        cout<<"error: message="<<_rpayload.name<<" decoded message differs from the source"<<endl;
+        return false;
+    }
+
+    //compress
+    const auto start_compress = SteadyClockT::now();
+    for(size_t i = 0; i < _rpar.iteration_count; ++i){
+        compressed_byte_count = compress(packets, compressed_packets);
+    }
+    const auto compress_duration = SteadyClockT::now() - start_compress;
+
+    //uncompress + deserialize
+    const auto start_uncompress = SteadyClockT::now();
+    for(size_t i = 0; i < _rpar.iteration_count; ++i){
+        uncompress(compressed_packets, uncompressed_packets);
+        recv_msg_ptr = deserialize(*des_ptr, rctx, uncompressed_packets);
+    }
+    const auto uncompress_duration = SteadyClockT::now() - start_uncompress;
+
+    if(!equal(source_msg_ptr, recv_msg_ptr)){
+        cout<<"error: message="<<_rpayload.name<<" uncompressed and decoded message differs from the source"<<endl;
+        return false;
+    }
+
+    cout<<"protocol"
+        <<" message="<<_rpayload.name
+        <<" iterations="<<_rpar.iteration_count
+        <<" packets="<<packets.size()
+        <<" bytes="<<byte_count
+        <<" compressed_bytes="<<compressed_byte_count
+        <<" compression_ratio="<<(compressed_byte_count ? static_cast<double>(byte_count) / compressed_byte_count : 0.0)
+        <<" serialize_ns="<<nsec_per(serialize_duration, _rpar.iteration_count)
+        <<" deserialize_ns="<<nsec_per(deserialize_duration, _rpar.iteration_count)
+        <<" serialize_compress_ns="<<nsec_per(serialize_duration + compress_duration, _rpar.iteration_count)
+        <<" uncompress_deserialize_ns="<<nsec_per(uncompress_duration, _rpar.iteration_count)
+        <<endl;
+    return true;
+}
+
+}//namespace
+
+int main(int argc, char *argv[]){
+    Parameters params;
+
+    if(parseArguments(params, argc, argv)) return 0;
+
+    auto proto = ProtocolT::create();
+
+    protocol_setup(NoopSetup(), *proto);
+
+    auto std_proto = ProtocolT::create();
+
+    std_proto->null(static_cast<ProtocolT::TypeIdT>(0));
+    NoopSetup()(*std_proto, TypeToType<StdEventsNotification>(), events_notification_type_id);
+
+    bool failed = false;
+
+    for(const auto &rpayload: make_payloads(params)){
+        if(!run(params, *proto, *std_proto, rpayload)){
+            failed = true;
+        }
+    }
+    return failed ? 1 : 0;
+}
+
+namespace{
+
+bool parseArguments(Parameters &_par, int argc, char *argv[]){
+    using namespace boost::program_options;
+    try{
+        options_description desc("Bubbles protocol benchmark");
+        desc.add_options()
+            ("help,h", "List program options")
+            ("iterations,i", value<size_t>(&_par.iteration_count)->default_value(10000), "Iterations per payload")
+            ("packet-size", value<size_t>(&_par.packet_size)->default_value(frame::mpipc::WriterConfiguration().max_packet_data_size), "Serialization buffer size - every buffer is compressed separately")
+            ("text-size", value<size_t>(&_par.text_size)->default_value(1000), "Text length of the long text payload - the protocol allows up to 1024")
+        ;
+        variables_map vm;
+        store(parse_command_line(argc, argv, desc), vm);
+        notify(vm);
+        if (vm.count("help")) {
+            cout << desc << "\n";
+            return true;
+        }
+        if(_par.packet_size == 0){
+            _par.packet_size = 1024;
+        }
+        return false;
+    }catch(exception& e){
+        cout << e.what() << "\n";
+        return true;
+    }
+}
+
+}//namespace
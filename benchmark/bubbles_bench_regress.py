@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+#
+# Benchmark regression runner.
+#
+# Runs the bubbles benchmarks, parses their key=value output lines and compares
+# them against the baselines checked in under benchmark/baselines.
+# Exits with 1 when a throughput metric drops or a time/latency metric grows
+# beyond the tolerance.
+#
+# Record (or refresh) the baselines on the reference machine with --update
+# and commit the resulting files.
+
+import argparse
+import os
+import shlex
+import subprocess
+import sys
+
+# Every benchmark line starts with a tag. For every tag:
+#   keys   - the fields identifying a line (e.g. the room size)
+#   lower  - metrics where a bigger value is a regression
+#   higher - metrics where a smaller value is a regression
+# All the other fields are informational.
+LINE_SPECS = {
+    'server_engine': {
+        'keys': ['phase', 'room_size'],
+        'lower': ['ns_per_op', 'ns_per_message'],
+        'higher': ['events_per_s'],
+    },
+    'protocol': {
+        'keys': ['message'],
+        'lower': ['bytes', 'compressed_bytes', 'serialize_ns', 'deserialize_ns', 'serialize_compress_ns', 'uncompress_deserialize_ns'],
+        'higher': ['compression_ratio'],
+    },
+    'render': {
+        'keys': ['mode', 'bubbles', 'antialias', 'size', 'zoom', 'colors'],
+        'lower': ['p50_us', 'p90_us', 'p99_us'],
+        'higher': [],
+    },
+    'client_pipeline': {
+        'keys': ['clients', 'rooms', 'rate'],
+        'lower': ['p50_us', 'p99_us'],
+        'higher': ['received_events_per_s', 'updates_per_s'],
+    },
+}
+
+# name -> (executable, default arguments) - short runs meant for CI
+BENCHMARKS = {
+    'server': ('bubbles_bench_server', ['--room-sizes', '2', '100', '1000', '10000', '--deliveries', '1000000', '--check-allocations']),
+    'protocol': ('bubbles_bench_protocol', ['--iterations', '2000']),
+    'render': ('bubbles_bench_render', ['--bubbles', '1000', '10000', '--frames', '100', '--many-colors']),
+    'client': ('bubbles_bench_client', ['--clients', '100', '--rate', '60', '--duration', '3']),
+}
+
+
+def parse_line(line):
+    fields = line.split()
+    if not fields or fields[0] not in LINE_SPECS:
+        return None
+    values = {}
+    for field in fields[1:]:
+        key, sep, value = field.partition('=')
+        if sep:
+            values[key] = value
+    return fields[0], values
+
+
+def line_id(tag, values):
+    spec = LINE_SPECS[tag]
+    return tag + ' ' + ' '.join('%s=%s' % (key, values.get(key, '?')) for key in spec['keys'])
+
+
+def parse_output(text):
+    results = {}
+    for line in text.splitlines():
+        parsed = parse_line(line)
+        if parsed:
+            tag, values = parsed
+            results[line_id(tag, values)] = (tag, values)
+    return results
+
+
+def better(tag, metric, lhs, rhs):
+    if metric in LINE_SPECS[tag]['higher']:
+        return max(lhs, rhs)
+    return min(lhs, rhs)
+
+
+def merge_best(best, results):
+    # keep the best value of every metric over the repeated runs - it is the least noisy one
+    for lid, (tag, values) in results.items():
+        if lid not in best:
+            best[lid] = (tag, dict(values))
+            continue
+        best_values = best[lid][1]
+        spec = LINE_SPECS[tag]
+        for metric in spec['lower'] + spec['higher']:
+            if metric in values and metric in best_values:
+                best_values[metric] = str(better(tag, metric, float(best_values[metric]), float(values[metric])))
+
+
+def format_results(results):
+    lines = []
+    for lid in sorted(results):
+        tag, values = results[lid]
+        lines.append(tag + ' ' + ' '.join('%s=%s' % (key, value) for key, value in values.items()))
+    return '\n'.join(lines) + '\n'
+
+
+def run_benchmark(bin_dir, name, extra_args, repeat):
+    executable, default_args = BENCHMARKS[name]
+    path = os.path.join(bin_dir, executable)
+    if not os.path.exists(path):
+        return None, 'not built: %s' % path
+    best = {}
+    for _ in range(repeat):
+        proc = subprocess.run([path] + (extra_args or default_args), stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        if proc.returncode != 0:
+            return None, '%s exited with %d:\n%s' % (executable, proc.returncode, proc.stdout)
+        results = parse_output(proc.stdout)
+        if not results:
+            return None, '%s printed no results:\n%s' % (executable, proc.stdout)
+        merge_best(best, results)
+    return best, None
+
+
+def tolerance_for(args, metric):
+    for item in args.tolerance_for:
+        key, _, value = item.partition('=')
+        if key == metric:
+            return float(value)
+    return args.tolerance
+
+
+def compare(args, name, baseline, current):
+    # returns the report lines and the number of regressions
+    report = []
+    regression_count = 0
+    for lid in sorted(baseline):
+        tag, base_values = baseline[lid]
+        if lid not in current:
+            report.append('  MISSING     %s' % lid)
+            regression_count += 1
+            continue
+        values = current[lid][1]
+        spec = LINE_SPECS[tag]
+        for metric in spec['lower'] + spec['higher']:
+            if metric not in base_values or metric not in values:
+                continue
+            base = float(base_values[metric])
+            value = float(values[metric])
+            if base == 0:
+                continue
+            change = (value - base) * 100.0 / base
+            limit = tolerance_for(args, metric)
+            worse = change > limit if metric in spec['lower'] else -change > limit
+            status = 'REGRESSION' if worse else 'ok'
+            if worse:
+                regression_count += 1
+            if worse or args.verbose:
+                report.append('  %-11s %s %s: %g -> %g (%+.1f%%, tolerance %g%%)' % (status, lid, metric, base, value, change, limit))
+    for lid in sorted(set(current) - set(baseline)):
+        report.append('  NEW         %s' % lid)
+    return report, regression_count
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Bubbles benchmark regression runner')
+    parser.add_argument('--bin-dir', required=True, help='directory holding the benchmark executables')
+    parser.add_argument('--baselines', default=os.path.join(os.path.dirname(os.path.abspath(__file__)), 'baselines'), help='baseline directory')
+    parser.add_argument('--bench', nargs='*', default=sorted(BENCHMARKS), choices=sorted(BENCHMARKS), help='benchmarks to run')
+    parser.add_argument('--tolerance', type=float, default=10.0, help='allowed change in percent')
+    parser.add_argument('--tolerance-for', action='append', default=[], metavar='METRIC=PERCENT', help='per metric tolerance, e.g. p99_us=25')
+    parser.add_argument('--repeat', type=int, default=3, help='runs per benchmark - the best value of every metric is kept')
+    parser.add_argument('--update', action='store_true', help='write the results as the new baselines')
+    parser.add_argument('--strict', action='store_true', help='fail when a benchmark is not built or has no baseline')
+    parser.add_argument('--verbose', action='store_true', help='print every compared metric')
+    parser.add_argument('--args', action='append', default=[], metavar='BENCH:ARGS', help='arguments replacing the default ones of one benchmark, e.g. "server:--room-sizes 2 100"')
+    args = parser.parse_args()
+
+    bench_args = {}
+    for item in args.args:
+        name, sep, value = item.partition(':')
+        if not sep or name not in BENCHMARKS:
+            parser.error('--args expects BENCH:ARGS with BENCH one of %s, got: %s' % (', '.join(sorted(BENCHMARKS)), item))
+        bench_args[name] = shlex.split(value)
+
+    failed = False
+
+    for name in args.bench:
+        current, error = run_benchmark(args.bin_dir, name, bench_args.get(name), max(args.repeat, 1))
+        if error:
+            print('%s: %s' % (name, error))
+            failed = failed or args.strict or not error.startswith('not built')
+            continue
+
+        baseline_path = os.path.join(args.baselines, name + '.txt')
+
+        if args.update:
+            os.makedirs(args.baselines, exist_ok=True)
+            with open(baseline_path, 'w') as baseline_file:
+                baseline_file.write(format_results(current))
+            print('%s: baseline written to %s' % (name, baseline_path))
+            continue
+
+        if not os.path.exists(baseline_path):
+            print('%s: no baseline at %s - record one with --update' % (name, baseline_path))
+            failed = failed or args.strict
+            continue
+
+        with open(baseline_path) as baseline_file:
+            baseline = parse_output(baseline_file.read())
+
+        report, regression_count = compare(args, name, baseline, current)
+        print('%s: %s' % (name, 'FAILED - %d regression(s)' % regression_count if regression_count else 'ok'))
+        for line in report:
+            print(line)
+        failed = failed or regression_count != 0
+
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,204 @@
+//Offscreen render benchmark for the Qt client paint path.
+//Renders synthetic plot snapshots into a QImage through bubbles::client::Renderer
+//(the code behind Widget::paintEvent) and reports frame time percentiles.
+
+#include "client/qt/src/bubbles_client_renderer.hpp"
+#include "client/engine/bubbles_client_viewport.hpp"
+
+#include "boost/program_options.hpp"
+
+#include <QGuiApplication>
+#include <QImage>
+#include <QPainter>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace bubbles::client;
+
+namespace{
+
+using PlotEntryVectorT = vector<PlotEntry>;
+using DurationVectorT = vector<std::chrono::microseconds>;
+
+const int canvas_width = 7680;
+const int canvas_height = 7680;
+
+struct Parameters{
+    Parameters(){}
+
+    vector<size_t>  bubble_counts;
+    size_t          frame_count;
+    size_t          warmup_count;
+    int             width;
+    int             height;
+    int             zoom_percent;
+    size_t          palette_size;
+    bool            many_colors;
+    bool            legacy;
+};
+
+bool parseArguments(Parameters &_par, int argc, char *argv[]);
+
+//the per bubble paint path used before the sprite renderer
+void draw_legacy(QPainter &_rpainter, const PlotEntry *_pentries, const size_t _count){
+    uint32_t r;
+    uint32_t g;
+    uint32_t b;
+    for(size_t i = 0; i < _count; ++i){
+        const PlotEntry &rentry = _pentries[i];
+        split_color(rentry.rgb_color, r, g, b);
+        _rpainter.setPen(QPen(QColor(r, g, b), 3));
+        _rpainter.setBrush(QBrush(QColor(r, g, b)));
+        _rpainter.drawEllipse(QRect(rentry.x - 10, rentry.y - 10, 20, 20));
+    }
+}
+
+std::chrono::microseconds percentile(const DurationVectorT &_rsorted, const size_t _percent){
+    if(_rsorted.empty()){
+        return std::chrono::microseconds(0);
+    }
+    const size_t idx = std::min(_rsorted.size() - 1, (_rsorted.size() * _percent) / 100);
+    return _rsorted[idx];
+}
+
+//_palette_size == 0 gives every bubble its own color
+void run(const Parameters &_rpar, const size_t _bubble_count, const bool _antialiased, const size_t _palette_size){
+    mt19937                             gen(_bubble_count);
+    uniform_int_distribution<int32_t>   dist_x(-canvas_width/2, canvas_width/2);
+    uniform_int_distribution<int32_t>   dist_y(-canvas_height/2, canvas_height/2);
+    uniform_int_distribution<int32_t>   dist_step(-16, 16);
+    PlotEntryVectorT                    canvas_entries(_bubble_count);
+    PlotEntryVectorT                    frame_entries(_bubble_count);
+    Viewport                            viewport(canvas_width, canvas_height, _rpar.width, _rpar.height);
+    Renderer                            renderer;
+    QImage                              image(_rpar.width, _rpar.height, QImage::Format_ARGB32_Premultiplied);
+    const QRect                         clip_rect(-_rpar.width/2, -_rpar.height/2, _rpar.width, _rpar.height);
+    DurationVectorT                     durations;
+
+    viewport.zoom((static_cast<int64_t>(Viewport::fixed_one) * _rpar.zoom_percent) / 100);
+    renderer.setAntialiased(_antialiased);
+
+    for(size_t i = 0; i < _bubble_count; ++i){
+        const size_t color_index = _palette_size ? (i % _palette_size) : i;
+
+        canvas_entries[i].x = dist_x(gen);
+        canvas_entries[i].y = dist_y(gen);
+        canvas_entries[i].rgb_color = (color_index + 1) * 2654435761u;//spread the colors, never 0
+    }
+
+    durations.reserve(_rpar.frame_count);
+
+    for(size_t frame = 0; frame < (_rpar.warmup_count + _rpar.frame_count); ++frame){
+        //every bubble moves a bit on every frame
+        for(auto &rentry: canvas_entries){
+            rentry.x = std::min(std::max(rentry.x + dist_step(gen), -canvas_width/2), canvas_width/2);
+            rentry.y = std::min(std::max(rentry.y + dist_step(gen), -canvas_height/2), canvas_height/2);
+        }
+
+        const auto start_time = std::chrono::steady_clock::now();
+
+        std::copy(canvas_entries.begin(), canvas_entries.end(), frame_entries.begin());
+        viewport.transform(frame_entries.data(), frame_entries.size());
+
+        image.fill(Qt::white);
+        {
+            QPainter painter(&image);
+            painter.translate(_rpar.width/2, _rpar.height/2);
+            if(_rpar.legacy){
+                painter.setRenderHint(QPainter::Antialiasing, _antialiased);
+                draw_legacy(painter, frame_entries.data(), frame_entries.size());
+            }else{
+                renderer.drawPlot(painter, frame_entries.data(), frame_entries.size(), clip_rect);
+                renderer.drawLocal(painter, 0, 0, 0xff);
+            }
+        }
+
+        if(frame >= _rpar.warmup_count){
+            durations.push_back(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time));
+        }
+    }
+
+    std::sort(durations.begin(), durations.end());
+
+    cout<<"render"
+        <<" mode="<<(_rpar.legacy ? "legacy" : "sprite")
+        <<" bubbles="<<_bubble_count
+        <<" antialias="<<(_antialiased ? "on" : "off")
+        <<" size="<<_rpar.width<<'x'<<_rpar.height
+        <<" zoom="<<_rpar.zoom_percent
+        <<" colors="<<(_palette_size ? std::to_string(_palette_size) : std::string("unique"))
+        <<" frames="<<durations.size()
+        <<" p50_us="<<percentile(durations, 50).count()
+        <<" p90_us="<<percentile(durations, 90).count()
+        <<" p99_us="<<percentile(durations, 99).count()
+        <<" max_us="<<(durations.empty() ? 0 : durations.back().count())
+        <<endl;
+}
+
+}//namespace
+
+int main(int argc, char *argv[]){
+    Parameters params;
+
+    if(parseArguments(params, argc, argv)) return 0;
+
+    if(qgetenv("QT_QPA_PLATFORM").isEmpty()){
+        //no window is ever shown
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QGuiApplication app(argc, argv);
+
+    for(const auto bubble_count: params.bubble_counts){
+        run(params, bubble_count, true, params.palette_size);
+        run(params, bubble_count, false, params.palette_size);
+    }
+    if(params.many_colors){
+        //stresses the sprite atlas: every bubble needs its own sprite
+        for(const auto bubble_count: params.bubble_counts){
+            run(params, bubble_count, true, 0);
+            run(params, bubble_count, false, 0);
+        }
+    }
+    return 0;
+}
+
+namespace{
+
+bool parseArguments(Parameters &_par, int argc, char *argv[]){
+    using namespace boost::program_options;
+    try{
+        options_description desc("Bubbles render benchmark");
+        desc.add_options()
+            ("help,h", "List program options")
+            ("bubbles,b", value<vector<size_t>>(&_par.bubble_counts)->multitoken()->default_value(vector<size_t>{100, 1000, 10000, 50000}, "100 1000 10000 50000"), "Bubble counts to render")
+            ("frames,f", value<size_t>(&_par.frame_count)->default_value(200), "Measured frames per run")
+            ("warmup", value<size_t>(&_par.warmup_count)->default_value(10), "Unmeasured frames rendered before measuring")
+            ("width", value<int>(&_par.width)->default_value(1280), "Image width")
+            ("height", value<int>(&_par.height)->default_value(720), "Image height")
+            ("zoom", value<int>(&_par.zoom_percent)->default_value(100), "Viewport zoom in percent - 100 shows the whole canvas")
+            ("palette", value<size_t>(&_par.palette_size)->default_value(64), "Distinct bubble colors - the peers of a room share a bounded palette")
+            ("many-colors", value<bool>(&_par.many_colors)->implicit_value(true)->default_value(false), "Also render every bubble count with a distinct color per bubble")
+            ("legacy", value<bool>(&_par.legacy)->implicit_value(true)->default_value(false), "Draw every bubble as an ellipse, like the paint path before the sprite renderer")
+        ;
+        variables_map vm;
+        store(parse_command_line(argc, argv, desc), vm);
+        notify(vm);
+        if (vm.count("help")) {
+            cout << desc << "\n";
+            return true;
+        }
+        return false;
+    }catch(exception& e){
+        cout << e.what() << "\n";
+        return true;
+    }
+}
+
+}//namespace
@@ -0,0 +1,314 @@
+//Server Engine micro-benchmark.
+//Drives bubbles::server::Engine through its transport independent entry points
+//against an in-memory Sender, so the fan-out cost is measured without sockets,
+//TLS or compression. Every message handed to the sink is completed right away
+//(Engine::eventsSent), the way mpipc does once a message is written.
+//
+//Phases, for every room size:
+//  join      - room_size members register one after the other
+//  fanout    - members take turns sending a move with --events extra events
+//  snapshot  - a new member joins the room and receives the last event of every member that moved
+//  leave     - members unregister, every departure is fanned out to the rest of the room
+//Prints one key=value line per phase.
+//
+//Every heap allocation is counted (global operator new) and reported per phase.
+//The moves are received into Engine::createEventsNotification messages, like the
+//loopback transport receives them, so the fanout phase covers the whole receive
+//and fan-out path. --check-allocations makes any allocation in the warm fanout
+//phase an error (exit code 1).
+
+#include "server/main/src/bubbles_server_engine.hpp"
+
+#include "boost/program_options.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace{
+std::atomic<uint64_t> allocation_count(0);
+}//namespace
+
+void* operator new(std::size_t _size){
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if(void *pv = std::malloc(_size ? _size : 1)){
+        return pv;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *_pv) noexcept{
+    std::free(_pv);
+}
+
+void operator delete(void *_pv, std::size_t) noexcept{
+    std::free(_pv);
+}
+
+using namespace std;
+using namespace bubbles;
+using namespace bubbles::server;
+
+namespace{
+
+using SteadyClockT = std::chrono::steady_clock;
+using EventsNotificationPointerT = std::shared_ptr<EventsNotification>;
+
+struct Parameters{
+    Parameters(){}
+
+    vector<size_t>  room_sizes;
+    size_t          event_count;
+    size_t          delivery_budget;
+    size_t          min_fanout_count;
+    size_t          snapshot_count;
+    size_t          leave_count;
+    size_t          max_pending_count;
+    bool            check_allocations;
+};
+
+bool parseArguments(Parameters &_par, int argc, char *argv[]);
+
+struct Delivery{
+    ConnectionData              *pcon_data;
+    EventsNotificationPointerT  msg_ptr;
+};
+
+using DeliveryVectorT = vector<Delivery>;
+
+class SinkSender: public Sender{
+public:
+    SinkSender():message_count(0), event_count(0){}
+
+    solid::ErrorConditionT sendMessage(
+        ConnectionData &_rcon_data,
+        EventsNotificationPointerT const &_rmsg_ptr
+    ) override{
+        deliveries.push_back(Delivery{&_rcon_data, _rmsg_ptr});
+        ++message_count;
+        event_count += 1 + _rmsg_ptr->event_stub.events.size() + _rmsg_ptr->event_stubs.size();
+        return solid::ErrorConditionT();
+    }
+
+    //complete every queued delivery - a completion can queue more (join snapshot continuation)
+    void drain(Engine &_rengine){
+        for(size_t i = 0; i < deliveries.size(); ++i){
+            ConnectionData              *pcon_data = deliveries[i].pcon_data;
+            EventsNotificationPointerT  msg_ptr = std::move(deliveries[i].msg_ptr);
+            _rengine.eventsSent(*pcon_data, msg_ptr);
+        }
+        deliveries.clear();
+    }
+
+    void resetCounters(){
+        message_count = 0;
+        event_count = 0;
+    }
+
+    size_t messageCount()const{
+        return message_count;
+    }
+
+    size_t eventCount()const{
+        return event_count;
+    }
+private:
+    DeliveryVectorT deliveries;
+    size_t          message_count;
+    size_t          event_count;
+};
+
+using ConnectionDataVectorT = vector<ConnectionData>;
+
+void report(
+    const char *_phase, const size_t _room_size, const size_t _op_count,
+    const SteadyClockT::duration &_duration, const size_t _message_count, const size_t _event_count,
+    const uint64_t _allocation_count
+){
+    const uint64_t  nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(_duration).count();
+    const double    seconds = nsec ? nsec / 1e9 : 1e-9;
+
+    cout<<"server_engine"
+        <<" phase="<<_phase
+        <<" room_size="<<_room_size
+        <<" ops="<<_op_count
+        <<" ns_per_op="<<(_op_count ? nsec / _op_count : 0)
+        <<" messages="<<_message_count
+        <<" ns_per_message="<<(_message_count ? nsec / _message_count : 0)
+        <<" events="<<_event_count
+        <<" events_per_s="<<static_cast<uint64_t>(_event_count / seconds)
+        <<" allocations="<<_allocation_count
+        <<endl;
+}
+
+EventsNotificationPointerT make_move(Engine &_rengine, const size_t _event_count, const int _x, const int _y){
+    auto msg_ptr = _rengine.createEventsNotification();
+
+    msg_ptr->event_stub.event.type = Event::PointerMove;
+    msg_ptr->event_stub.event.x = _x;
+    msg_ptr->event_stub.event.y = _y;
+
+    for(size_t i = 0; i < _event_count; ++i){
+        msg_ptr->event_stub.events.push_back(Event(Event::PointerMove));
+        msg_ptr->event_stub.events.back().x = _x + static_cast<int>(i);
+        msg_ptr->event_stub.events.back().y = _y - static_cast<int>(i);
+    }
+    return msg_ptr;
+}
+
+//returns false if a registration or --check-allocations failed
+bool run(const Parameters &_rpar, const size_t _room_size){
+    if(_room_size == 0){
+        return true;
+    }
+    EngineConfiguration     cfg;
+
+    cfg.connection_max_pending_count = _rpar.max_pending_count;
+
+    SinkSender              sink;
+    Engine                  engine(cfg, sink);
+    ConnectionDataVectorT   members(_room_size);//never resized - the engine keeps pointers
+    ConnectionData          newcomer;
+    const RegisterRequest   request("bench", 0);
+    uint32_t                rgb_color;
+    bool                    success = true;
+
+    //join
+    {
+        const uint64_t  start_allocation_count = allocation_count;
+        const auto      start_time = SteadyClockT::now();
+        for(auto &rmember: members){
+            if(engine.registerConnection(rmember, request, rgb_color) != 0){
+                cout<<"error: registration failed at room size "<<_room_size<<endl;
+                return false;
+            }
+            sink.drain(engine);
+        }
+        report("join", _room_size, members.size(), SteadyClockT::now() - start_time, sink.messageCount(), sink.eventCount(), allocation_count - start_allocation_count);
+    }
+
+    //fanout
+    const size_t fanout_count = std::max(_rpar.min_fanout_count, _rpar.delivery_budget / std::max(_room_size, static_cast<size_t>(1)));
+    {
+        //warm up - fills the engine pools and the sink queue, not measured
+        for(size_t i = 0; i < std::min(fanout_count, static_cast<size_t>(4)); ++i){
+            EventsNotificationPointerT msg_ptr = make_move(engine, _rpar.event_count, static_cast<int>(i), static_cast<int>(i));
+            engine.eventsReceived(members[i % members.size()], msg_ptr);
+            sink.drain(engine);
+        }
+
+        sink.resetCounters();
+        const uint64_t  start_allocation_count = allocation_count;
+        const auto      start_time = SteadyClockT::now();
+        for(size_t i = 0; i < fanout_count; ++i){
+            EventsNotificationPointerT msg_ptr = make_move(engine, _rpar.event_count, static_cast<int>(i), static_cast<int>(i));
+            engine.eventsReceived(members[i % members.size()], msg_ptr);
+            sink.drain(engine);
+        }
+        const uint64_t  fanout_allocation_count = allocation_count - start_allocation_count;
+
+        report("fanout", _room_size, fanout_count, SteadyClockT::now() - start_time, sink.messageCount(), sink.eventCount(), fanout_allocation_count);
+
+        if(_rpar.check_allocations and fanout_allocation_count != 0){
+            cout<<"error: "<<fanout_allocation_count<<" allocations in the steady state fanout at room size "<<_room_size<<endl;
+            success = false;
+        }
+    }
+
+    //snapshot - std::min(fanout_count, room_size) members have a last event
+    {
+        SteadyClockT::duration  duration(0);
+        size_t                  message_count = 0;
+        size_t                  event_count = 0;
+        uint64_t                snapshot_allocation_count = 0;
+
+        for(size_t i = 0; i < _rpar.snapshot_count; ++i){
+            sink.resetCounters();
+
+            const uint64_t  start_allocation_count = allocation_count;
+            const auto      start_time = SteadyClockT::now();
+            engine.registerConnection(newcomer, request, rgb_color);
+            sink.drain(engine);
+            duration += SteadyClockT::now() - start_time;
+            snapshot_allocation_count += allocation_count - start_allocation_count;
+
+            message_count += sink.messageCount();
+            event_count += sink.eventCount();
+
+            engine.unregisterConnection(newcomer);
+            sink.drain(engine);
+        }
+        report("snapshot", _room_size, _rpar.snapshot_count, duration, message_count, event_count, snapshot_allocation_count);
+    }
+
+    //leave
+    {
+        const size_t leave_count = std::min(_rpar.leave_count, members.size());
+
+        sink.resetCounters();
+        const uint64_t  start_allocation_count = allocation_count;
+        const auto      start_time = SteadyClockT::now();
+        for(size_t i = 0; i < leave_count; ++i){
+            engine.unregisterConnection(members[i]);
+            sink.drain(engine);
+        }
+        report("leave", _room_size, leave_count, SteadyClockT::now() - start_time, sink.messageCount(), sink.eventCount(), allocation_count - start_allocation_count);
+    }
+    return success;
+}
+
+}//namespace
+
+int main(int argc, char *argv[]){
+    Parameters params;
+
+    if(parseArguments(params, argc, argv)) return 0;
+
+    bool success = true;
+
+    for(const auto room_size: params.room_sizes){
+        if(not run(params, room_size)){
+            success = false;
+        }
+    }
+    return success ? 0 : 1;
+}
+
+namespace{
+
+bool parseArguments(Parameters &_par, int argc, char *argv[]){
+    using namespace boost::program_options;
+    try{
+        options_description desc("Bubbles server engine benchmark");
+        desc.add_options()
+            ("help,h", "List program options")
+            ("room-sizes,r", value<vector<size_t>>(&_par.room_sizes)->multitoken()->default_value(vector<size_t>{2, 10, 100, 1000, 10000, 100000}, "2 10 100 1000 10000 100000"), "Room sizes to measure")
+            ("events,e", value<size_t>(&_par.event_count)->default_value(3), "Extra events carried by every move")
+            ("deliveries", value<size_t>(&_par.delivery_budget)->default_value(2000000), "Fan-out deliveries per room size - sets the number of fan-outs")
+            ("min-fanouts", value<size_t>(&_par.min_fanout_count)->default_value(10), "Minimum fan-outs per room size")
+            ("snapshots", value<size_t>(&_par.snapshot_count)->default_value(10), "Joins measured in the snapshot phase")
+            ("leaves", value<size_t>(&_par.leave_count)->default_value(100), "Departures measured in the leave phase")
+            ("max-pending", value<size_t>(&_par.max_pending_count)->default_value(EngineConfiguration().connection_max_pending_count), "EngineConfiguration::connection_max_pending_count")
+            ("check-allocations", value<bool>(&_par.check_allocations)->implicit_value(true)->default_value(false), "Fail if the warm fanout phase allocates")
+        ;
+        variables_map vm;
+        store(parse_command_line(argc, argv, desc), vm);
+        notify(vm);
+        if (vm.count("help")) {
+            cout << desc << "\n";
+            return true;
+        }
+        return false;
+    }catch(exception& e){
+        cout << e.what() << "\n";
+        return true;
+    }
+}
+
+}//namespace
@@ -0,0 +1,481 @@
+//Networked load generator.
+//Opens many bubbles clients from one process through the headless client core,
+//spread over a number of rooms, and moves every bubble on a seeded random-waypoint
+//trajectory. Clients can be made to leave and rejoin (churn) and all connections
+//can be dropped and reestablished at once (reconnect storm).
+//Prints one key=value line per report interval and a summary at the end.
+//
+//Latency probe: the first --probes members of every room stamp their moves with
+//the send time and every receiving client in the process records the one-way
+//latency against the same steady clock. Percentiles are reported per interval
+//and, at the end, per room size together with the secure/compress settings.
+
+#include "client/core/bubbles_client_core.hpp"
+
+#include "boost/program_options.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace{
+
+using SteadyClockT = std::chrono::steady_clock;
+using SteadyTimePointT = SteadyClockT::time_point;
+
+//same canvas as bubbles::client::Engine
+const int canvas_half_width = 7680/2;
+const int canvas_half_height = 7680/2;
+
+struct Parameters{
+    Parameters(){}
+
+    string      connect_addr;
+    string      room_prefix;
+    size_t      client_count;
+    size_t      room_count;
+    vector<size_t>  room_sizes;
+    size_t      probe_count;
+    uint32_t    seed;
+    size_t      move_rate;
+    size_t      join_rate;
+    size_t      duration_seconds;
+    size_t      report_seconds;
+    size_t      churn_seconds;
+    size_t      churn_percent;
+    size_t      storm_seconds;
+    size_t      storm_down_msec;
+    bool        secure;
+    bool        compress;
+    int         aio_thread_count;
+    int         thread_count;
+};
+
+bool parseArguments(Parameters &_par, int argc, char *argv[]);
+
+//random-waypoint walk - like Engine::onAutoPilot but driven by a seeded generator
+struct Trajectory{
+    Trajectory(
+        const uint32_t _seed = 0
+    ):  gen(_seed), dist_x(-canvas_half_width, canvas_half_width),
+        dist_y(-canvas_half_height, canvas_half_height), dist_steps(10, 100),
+        x(0), y(0), from_x(0), from_y(0), to_x(0), to_y(0), step(0), step_count(0){}
+
+    void next(int &_rx, int &_ry){
+        if(step == step_count){
+            from_x = x;
+            from_y = y;
+            to_x = dist_x(gen);
+            to_y = dist_y(gen);
+            step_count = dist_steps(gen);
+            step = 0;
+        }
+        ++step;
+        x = from_x + ((to_x - from_x) * step) / step_count;
+        y = from_y + ((to_y - from_y) * step) / step_count;
+        _rx = x;
+        _ry = y;
+    }
+
+    std::mt19937                        gen;
+    std::uniform_int_distribution<int>  dist_x;
+    std::uniform_int_distribution<int>  dist_y;
+    std::uniform_int_distribution<int>  dist_steps;
+    int                                 x;
+    int                                 y;
+    int                                 from_x;
+    int                                 from_y;
+    int                                 to_x;
+    int                                 to_y;
+    int                                 step;
+    int                                 step_count;
+};
+
+struct Slot{
+    Slot():pcli(nullptr), room_size(0), probe(false){}
+
+    BubblesClient   *pcli;
+    Trajectory      trajectory;
+    string          room;
+    size_t          room_size;
+    bool            probe;
+};
+
+using SlotVectorT = vector<Slot>;
+using LatencyMapT = std::map<size_t, BubblesLatencyHistogram*>;//by room size
+
+void add_statistics(BubblesClientStatistics &_rto, const BubblesClientStatistics &_rfrom){
+    _rto.sent_message_count += _rfrom.sent_message_count;
+    _rto.sent_event_count += _rfrom.sent_event_count;
+    _rto.received_message_count += _rfrom.received_message_count;
+    _rto.received_event_count += _rfrom.received_event_count;
+    _rto.dropped_event_count += _rfrom.dropped_event_count;
+    _rto.connection_stop_count += _rfrom.connection_stop_count;
+    _rto.sent_byte_count += _rfrom.sent_byte_count;
+}
+
+void clear_statistics(BubblesClientStatistics &_rstat){
+    _rstat = BubblesClientStatistics{0, 0, 0, 0, 0, 0, 0};
+}
+
+class LoadGenerator{
+public:
+    LoadGenerator(
+        const Parameters &_rpar, BubblesContext *_pctx
+    ):  rpar(_rpar), pctx(_pctx), churn_gen(_rpar.seed),
+        room_count(_rpar.room_count), live_count(0), error_count(0), storm_down(false),
+        pcollect_latency(bubbles_latency_histogram_create()),
+        pinterval_latency(bubbles_latency_histogram_create())
+    {
+        clear_statistics(retired_statistics);
+        clear_statistics(last_statistics);
+
+        bubbles_client_config_init(&config);
+        config.endpoint = rpar.connect_addr.c_str();
+        config.secure = rpar.secure ? 1 : 0;
+        config.compress = rpar.compress ? 1 : 0;
+        //a storm must really drop the connections
+        config.suspend_on_pause = 0;
+        //the load generator paces the moves itself
+        config.move_min_distance = 0;
+        config.move_min_interval_msec = 0;
+
+        if(rpar.room_sizes.size()){
+            //explicit room sizes - the client count is their sum
+            room_count = rpar.room_sizes.size();
+            for(size_t i = 0; i < rpar.room_sizes.size(); ++i){
+                for(size_t j = 0; j < rpar.room_sizes[i]; ++j){
+                    slots.push_back(Slot{});
+                    slots.back().room = rpar.room_prefix + std::to_string(i);
+                    slots.back().room_size = rpar.room_sizes[i];
+                    slots.back().probe = j < rpar.probe_count;
+                }
+            }
+        }else{
+            slots.resize(rpar.client_count);
+            for(size_t i = 0; i < slots.size(); ++i){
+                const size_t room_index = i % room_count;
+                slots[i].room = rpar.room_prefix + std::to_string(room_index);
+                slots[i].room_size = (slots.size() - room_index + room_count - 1) / room_count;
+                slots[i].probe = (i / room_count) < rpar.probe_count;
+            }
+        }
+
+        for(size_t i = 0; i < slots.size(); ++i){
+            slots[i].trajectory = Trajectory(rpar.seed + static_cast<uint32_t>(i));
+            if(latency_map.find(slots[i].room_size) == latency_map.end()){
+                latency_map[slots[i].room_size] = bubbles_latency_histogram_create();
+            }
+        }
+    }
+
+    ~LoadGenerator(){
+        for(auto &rslot: slots){
+            leave(rslot);
+        }
+        for(auto &rpair: latency_map){
+            bubbles_latency_histogram_destroy(rpair.second);
+        }
+        bubbles_latency_histogram_destroy(pinterval_latency);
+        bubbles_latency_histogram_destroy(pcollect_latency);
+    }
+
+    void run();
+private:
+    void join(Slot &_rslot);
+    void leave(Slot &_rslot);
+    void churn();
+    void statistics(BubblesClientStatistics &_rstat);
+    void collectLatency(Slot &_rslot);
+    void report(const SteadyTimePointT &_rnow, const bool _final);
+    void reportLatency();
+private:
+    const Parameters            &rpar;
+    BubblesContext              *pctx;
+    BubblesClientConfig         config;
+    SlotVectorT                 slots;
+    std::mt19937                churn_gen;
+    size_t                      room_count;
+    size_t                      live_count;
+    size_t                      error_count;
+    bool                        storm_down;
+    BubblesClientStatistics     retired_statistics;//collected from the clients that left
+    BubblesClientStatistics     last_statistics;
+    SteadyTimePointT            start_time;
+    SteadyTimePointT            last_report_time;
+    BubblesLatencyHistogram     *pcollect_latency;
+    BubblesLatencyHistogram     *pinterval_latency;
+    LatencyMapT                 latency_map;
+};
+
+void LoadGenerator::join(Slot &_rslot){
+    config.room = _rslot.room.c_str();
+    config.probe = _rslot.probe ? 1 : 0;
+
+    _rslot.pcli = bubbles_client_create(pctx, &config);
+
+    if(_rslot.pcli == nullptr){
+        ++error_count;
+        return;
+    }
+    if(bubbles_client_start(_rslot.pcli) != 0){
+        bubbles_client_destroy(_rslot.pcli);
+        _rslot.pcli = nullptr;
+        ++error_count;
+        return;
+    }
+    ++live_count;
+}
+
+void LoadGenerator::leave(Slot &_rslot){
+    if(_rslot.pcli){
+        BubblesClientStatistics stat;
+        bubbles_client_statistics(_rslot.pcli, &stat);
+        add_statistics(retired_statistics, stat);
+        collectLatency(_rslot);
+        bubbles_client_destroy(_rslot.pcli);
+        _rslot.pcli = nullptr;
+        --live_count;
+    }
+}
+
+void LoadGenerator::churn(){
+    std::uniform_int_distribution<size_t>   dist_idx(0, slots.size() - 1);
+    const size_t                            count = (slots.size() * rpar.churn_percent) / 100;
+
+    for(size_t i = 0; i < count; ++i){
+        Slot &rslot = slots[dist_idx(churn_gen)];
+        if(rslot.pcli){
+            leave(rslot);
+            join(rslot);
+        }
+    }
+}
+
+void LoadGenerator::statistics(BubblesClientStatistics &_rstat){
+    _rstat = retired_statistics;
+    for(auto &rslot: slots){
+        if(rslot.pcli){
+            BubblesClientStatistics stat;
+            bubbles_client_statistics(rslot.pcli, &stat);
+            add_statistics(_rstat, stat);
+        }
+    }
+}
+
+void LoadGenerator::collectLatency(Slot &_rslot){
+    bubbles_latency_histogram_clear(pcollect_latency);
+    bubbles_client_collect_latency(_rslot.pcli, pcollect_latency);
+    bubbles_latency_histogram_merge(pinterval_latency, pcollect_latency);
+    bubbles_latency_histogram_merge(latency_map[_rslot.room_size], pcollect_latency);
+}
+
+void LoadGenerator::report(const SteadyTimePointT &_rnow, const bool _final){
+    BubblesClientStatistics stat;
+    BubblesClientStatistics last = last_statistics;
+
+    statistics(stat);
+
+    for(auto &rslot: slots){
+        if(rslot.pcli){
+            collectLatency(rslot);
+        }
+    }
+
+    if(_final){
+        clear_statistics(last);
+    }
+
+    const SteadyTimePointT  &rsince = _final ? start_time : last_report_time;
+    const double            seconds = std::chrono::duration<double>(_rnow - rsince).count();
+    const double            divider = seconds > 0 ? seconds : 1;
+
+    cout<<(_final ? "loadgen_total" : "loadgen")
+        <<" time_s="<<std::chrono::duration_cast<std::chrono::seconds>(_rnow - start_time).count()
+        <<" clients="<<live_count
+        <<" rooms="<<room_count
+        <<" sent_updates_per_s="<<static_cast<uint64_t>((stat.sent_event_count - last.sent_event_count) / divider)
+        <<" delivered_updates_per_s="<<static_cast<uint64_t>((stat.received_event_count - last.received_event_count) / divider)
+        <<" sent_messages_per_s="<<static_cast<uint64_t>((stat.sent_message_count - last.sent_message_count) / divider)
+        <<" received_messages_per_s="<<static_cast<uint64_t>((stat.received_message_count - last.received_message_count) / divider)
+        <<" sent_bytes_per_s="<<static_cast<uint64_t>((stat.sent_byte_count - last.sent_byte_count) / divider)
+        <<" dropped="<<(stat.dropped_event_count - last.dropped_event_count)
+        <<" connection_stops="<<(stat.connection_stop_count - last.connection_stop_count)
+        <<" errors="<<error_count;
+    if(!_final && rpar.probe_count){
+        cout<<" latency_samples="<<bubbles_latency_histogram_count(pinterval_latency)
+            <<" p50_us="<<bubbles_latency_histogram_percentile(pinterval_latency, 50)
+            <<" p99_us="<<bubbles_latency_histogram_percentile(pinterval_latency, 99)
+            <<" p999_us="<<bubbles_latency_histogram_percentile(pinterval_latency, 99.9);
+    }
+    cout<<endl;
+
+    if(_final && rpar.probe_count){
+        reportLatency();
+    }
+
+    bubbles_latency_histogram_clear(pinterval_latency);
+    last_statistics = stat;
+    last_report_time = _rnow;
+}
+
+void LoadGenerator::reportLatency(){
+    for(const auto &rpair: latency_map){
+        const BubblesLatencyHistogram *phist = rpair.second;
+        cout<<"latency"
+            <<" room_size="<<rpair.first
+            <<" secure="<<(rpar.secure ? "on" : "off")
+            <<" compress="<<(rpar.compress ? "on" : "off")
+            <<" probes="<<rpar.probe_count
+            <<" samples="<<bubbles_latency_histogram_count(phist)
+            <<" p50_us="<<bubbles_latency_histogram_percentile(phist, 50)
+            <<" p99_us="<<bubbles_latency_histogram_percentile(phist, 99)
+            <<" p999_us="<<bubbles_latency_histogram_percentile(phist, 99.9)
+            <<" max_us="<<bubbles_latency_histogram_max(phist)
+            <<endl;
+    }
+}
+
+void LoadGenerator::run(){
+    const std::chrono::microseconds tick(1000000 / std::max(rpar.move_rate, static_cast<size_t>(1)));
+    const size_t                    join_per_tick = rpar.join_rate ? std::max(static_cast<size_t>(1), rpar.join_rate / std::max(rpar.move_rate, static_cast<size_t>(1))) : slots.size();
+    size_t                          join_idx = 0;
+    SteadyTimePointT                now = SteadyClockT::now();
+    SteadyTimePointT                next_tick = now;
+    const SteadyTimePointT          end_time = now + std::chrono::seconds(rpar.duration_seconds);
+    SteadyTimePointT                next_report = now + std::chrono::seconds(rpar.report_seconds);
+    SteadyTimePointT                next_churn = now + std::chrono::seconds(rpar.churn_seconds);
+    SteadyTimePointT                next_storm = now + std::chrono::seconds(rpar.storm_seconds);
+    SteadyTimePointT                storm_end;
+
+    start_time = now;
+    last_report_time = now;
+
+    while(now < end_time){
+        //ramp up
+        for(size_t i = 0; i < join_per_tick && join_idx < slots.size(); ++i, ++join_idx){
+            join(slots[join_idx]);
+        }
+
+        if(!storm_down){
+            int x, y;
+            for(auto &rslot: slots){
+                if(rslot.pcli){
+                    rslot.trajectory.next(x, y);
+                    bubbles_client_move(rslot.pcli, x, y);
+                }
+            }
+        }
+
+        if(rpar.churn_seconds && rpar.churn_percent && now >= next_churn && join_idx == slots.size()){
+            churn();
+            next_churn += std::chrono::seconds(rpar.churn_seconds);
+        }
+
+        if(rpar.storm_seconds){
+            if(storm_down){
+                if(now >= storm_end){
+                    for(auto &rslot: slots){
+                        if(rslot.pcli) bubbles_client_resume(rslot.pcli);
+                    }
+                    storm_down = false;
+                }
+            }else if(now >= next_storm){
+                for(auto &rslot: slots){
+                    if(rslot.pcli) bubbles_client_pause(rslot.pcli);
+                }
+                storm_down = true;
+                storm_end = now + std::chrono::milliseconds(rpar.storm_down_msec);
+                next_storm += std::chrono::seconds(rpar.storm_seconds);
+            }
+        }
+
+        if(now >= next_report){
+            report(now, false);
+            next_report += std::chrono::seconds(rpar.report_seconds);
+        }
+
+        next_tick += tick;
+        std::this_thread::sleep_until(next_tick);
+        now = SteadyClockT::now();
+    }
+    report(now, true);
+}
+
+}//namespace
+
+int main(int argc, char *argv[]){
+    Parameters params;
+
+    if(parseArguments(params, argc, argv)) return 0;
+
+    BubblesContext *pctx = bubbles_context_create(params.aio_thread_count, params.thread_count);
+
+    if(pctx == nullptr){
+        cout<<"Error creating the client context"<<endl;
+        return 1;
+    }
+    {
+        LoadGenerator   loadgen(params, pctx);
+        loadgen.run();
+    }
+    bubbles_context_destroy(pctx);
+    return 0;
+}
+
+namespace{
+
+bool parseArguments(Parameters &_par, int argc, char *argv[]){
+    using namespace boost::program_options;
+    try{
+        options_description desc("Bubbles load generator");
+        desc.add_options()
+            ("help,h", "List program options")
+            ("connect,c", value<string>(&_par.connect_addr)->default_value("localhost:4444"), "Server address")
+            ("clients,n", value<size_t>(&_par.client_count)->default_value(1000), "Number of connections")
+            ("rooms,m", value<size_t>(&_par.room_count)->default_value(10), "Number of rooms the connections are spread over")
+            ("room-sizes", value<vector<size_t>>(&_par.room_sizes)->multitoken(), "Explicit member count of every room - overrides --clients and --rooms")
+            ("probes", value<size_t>(&_par.probe_count)->default_value(0), "Latency probe clients per room - 0 disables the latency probe")
+            ("room-prefix", value<string>(&_par.room_prefix)->default_value("load"), "Room name prefix - the room index is appended")
+            ("seed", value<uint32_t>(&_par.seed)->default_value(1), "Trajectory and churn seed")
+            ("rate,r", value<size_t>(&_par.move_rate)->default_value(10), "Moves per second per client")
+            ("join-rate", value<size_t>(&_par.join_rate)->default_value(500), "Connections opened per second while ramping up - 0 opens all at once")
+            ("duration,d", value<size_t>(&_par.duration_seconds)->default_value(60), "Test duration in seconds")
+            ("report", value<size_t>(&_par.report_seconds)->default_value(1), "Report interval in seconds")
+            ("churn-interval", value<size_t>(&_par.churn_seconds)->default_value(0), "Seconds between churn rounds - 0 disables churn")
+            ("churn-percent", value<size_t>(&_par.churn_percent)->default_value(5), "Percent of the clients leaving and rejoining on every churn round")
+            ("storm-interval", value<size_t>(&_par.storm_seconds)->default_value(0), "Seconds between reconnect storms - 0 disables storms")
+            ("storm-down", value<size_t>(&_par.storm_down_msec)->default_value(1000), "Milliseconds all clients stay disconnected during a storm")
+            ("secure,s", value<bool>(&_par.secure)->implicit_value(true)->default_value(true), "Use SSL to secure communication")
+            ("compress", value<bool>(&_par.compress)->implicit_value(true)->default_value(true), "Use Snappy to compress communication - needed for sent_bytes_per_s")
+            ("aio-threads", value<int>(&_par.aio_thread_count)->default_value(2), "Network threads")
+            ("threads", value<int>(&_par.thread_count)->default_value(2), "Engine threads")
+        ;
+        variables_map vm;
+        store(parse_command_line(argc, argv, desc), vm);
+        notify(vm);
+        if (vm.count("help")) {
+            cout << desc << "\n";
+            return true;
+        }
+        if(_par.room_count == 0){
+            _par.room_count = 1;
+        }
+        if(_par.report_seconds == 0){
+            _par.report_seconds = 1;
+        }
+        return false;
+    }catch(exception& e){
+        cout << e.what() << "\n";
+        return true;
+    }
+}
+
+}//namespace
@@ -0,0 +1,251 @@
+#include "benchmark/bubbles_loopback.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace bubbles{
+namespace loopback{
+
+using EventsNotificationPointerT = std::shared_ptr<EventsNotification>;
+
+//=============================================================================
+struct Connection::Data: server::ConnectionData{
+    Data(Server &_rserver):rserver(_rserver), pengine(nullptr){}
+
+    Server          &rserver;
+    client::Engine  *pengine;//the engine connected - only used on the server thread
+};
+
+//=============================================================================
+struct Server::Task{
+    enum TypeE{
+        SendEvents,
+        Suspend,
+        Close,
+    };
+
+    Task(
+        const TypeE _type, Connection::Data &_rcon_data, client::Engine &_rengine,
+        EventsNotificationPointerT const &_rmsg_ptr = EventsNotificationPointerT(),
+        const bool _suspend = false
+    ):type(_type), pcon_data(&_rcon_data), pengine(&_rengine), msg_ptr(_rmsg_ptr), suspend(_suspend){}
+
+    TypeE                       type;
+    Connection::Data            *pcon_data;
+    client::Engine              *pengine;
+    EventsNotificationPointerT  msg_ptr;
+    bool                        suspend;
+};
+
+//the server Engine, its Sender and the task queue it is driven from
+//everything but the task queue is only touched on the server thread
+struct Server::Data: server::Sender{
+    struct Delivery{
+        Connection::Data            *pcon_data;
+        EventsNotificationPointerT  msg_ptr;
+    };
+
+    using TaskDequeT = deque<Task>;
+    using DeliveryVectorT = vector<Delivery>;
+
+    Data(const server::EngineConfiguration &_rcfg):engine(_rcfg, *this), call_count(0), stopping(false){}
+
+    solid::ErrorConditionT sendMessage(
+        server::ConnectionData &_rcon_data,
+        EventsNotificationPointerT const &_rmsg_ptr
+    ) override{
+        deliveries.push_back(Delivery{&static_cast<Connection::Data&>(_rcon_data), _rmsg_ptr});
+        return solid::ErrorConditionT();
+    }
+
+    void run();
+    void execute(Task &_rtask);
+    bool connect(Connection::Data &_rcon_data, client::Engine &_rengine);
+    void drain();
+
+    server::Engine          engine;
+    DeliveryVectorT         deliveries;
+    std::atomic<uint64_t>   call_count;
+
+    mutex                   mtx;
+    condition_variable      cnd;
+    TaskDequeT              taskdq;//guarded by mtx
+    TaskDequeT              exec_taskdq;
+    bool                    stopping;//guarded by mtx
+    thread                  thr;
+};
+
+void Server::Data::run(){
+    std::unique_lock<std::mutex>    lock(mtx);
+
+    while(true){
+        while(taskdq.empty() and not stopping){
+            cnd.wait(lock);
+        }
+        if(taskdq.empty()){
+            break;
+        }
+        swap(taskdq, exec_taskdq);
+        lock.unlock();
+
+        for(auto &rtask: exec_taskdq){
+            execute(rtask);
+            drain();
+        }
+        exec_taskdq.clear();
+
+        lock.lock();
+    }
+}
+
+void Server::Data::execute(Task &_rtask){
+    Connection::Data &rcon_data = *_rtask.pcon_data;
+
+    switch(_rtask.type){
+        case Task::SendEvents:
+            if(rcon_data.registered() or connect(rcon_data, *_rtask.pengine)){
+                //the server keeps and changes what it receives - give it its own copy
+                EventsNotificationPointerT msg_ptr = engine.createEventsNotification();
+
+                msg_ptr->event_stub = _rtask.msg_ptr->event_stub;
+                msg_ptr->event_stubs = _rtask.msg_ptr->event_stubs;
+
+                ++call_count;
+                engine.eventsReceived(rcon_data, msg_ptr);
+            }
+            //the server Engine is done with it - what an acknowledgement would report
+            _rtask.pengine->eventsSent(_rtask.msg_ptr, true);
+            break;
+        case Task::Suspend:
+            if(rcon_data.registered()){
+                ++call_count;
+                engine.suspendConnection(rcon_data, _rtask.suspend);
+            }
+            break;
+        case Task::Close:
+            if(rcon_data.registered()){
+                ++call_count;
+                engine.unregisterConnection(rcon_data);
+                _rtask.pengine->connectionStop();
+            }
+            break;
+    }
+}
+
+//what mpipc does on the first message to the server: connect, register, activate
+bool Server::Data::connect(Connection::Data &_rcon_data, client::Engine &_rengine){
+    RegisterRequest req;
+
+    _rcon_data.pengine = &_rengine;
+
+    if(not _rengine.connectionStart(req)){
+        _rengine.connectionStop();
+        return false;
+    }
+
+    uint32_t        rgb_color = 0;
+    const uint32_t  error_id = engine.registerConnection(_rcon_data, req, rgb_color);
+
+    ++call_count;
+
+    if(error_id == 0 and _rengine.connectionRegistered(RegisterResponse(req, rgb_color))){
+        return true;
+    }
+
+    if(error_id != 0){
+        _rengine.connectionRegistered(RegisterResponse(req, error_id, "registration failed"));
+    }
+    if(_rcon_data.registered()){
+        engine.unregisterConnection(_rcon_data);
+    }
+    _rengine.connectionStop();
+    return false;
+}
+
+//hand the messages the server Engine sent to the client Engines and report them back as written
+//a completion can queue more (join snapshot continuation)
+void Server::Data::drain(){
+    for(size_t i = 0; i < deliveries.size(); ++i){
+        Connection::Data            &rcon_data = *deliveries[i].pcon_data;
+        EventsNotificationPointerT  msg_ptr = std::move(deliveries[i].msg_ptr);
+
+        if(not rcon_data.registered()){
+            continue;
+        }
+        //the same message is fanned out to the whole room - every client gets a copy
+        EventsNotificationPointerT  recv_msg_ptr = std::make_shared<EventsNotification>(*msg_ptr);
+
+        rcon_data.pengine->eventsReceived(recv_msg_ptr);
+
+        ++call_count;
+        engine.eventsSent(rcon_data, msg_ptr);
+    }
+    deliveries.clear();
+}
+
+//=============================================================================
+Server::Server(const server::EngineConfiguration &_rcfg):d(*(new Data(_rcfg))){
+    d.thr = std::thread(&Data::run, &d);
+}
+
+Server::~Server(){
+    {
+        std::unique_lock<std::mutex>    lock(d.mtx);
+        d.stopping = true;
+    }
+    d.cnd.notify_one();
+    d.thr.join();
+    delete &d;
+}
+
+uint64_t Server::callCount()const{
+    return d.call_count;
+}
+
+void Server::push(Task &&_utask){
+    bool notify = false;
+    {
+        std::unique_lock<std::mutex>    lock(d.mtx);
+        d.taskdq.push_back(std::move(_utask));
+        notify = (d.taskdq.size() == 1);
+    }
+    if(notify){
+        d.cnd.notify_one();
+    }
+}
+
+//=============================================================================
+Connection::Connection(Server &_rserver):d(*(new Data(_rserver))){}
+
+Connection::~Connection(){
+    delete &d;
+}
+
+solid::ErrorConditionT Connection::sendEvents(
+    client::Engine &_rengine,
+    std::shared_ptr<EventsNotification> const &_rmsg_ptr
+){
+    d.rserver.push(Server::Task(Server::Task::SendEvents, d, _rengine, _rmsg_ptr));
+    return solid::ErrorConditionT();
+}
+
+solid::ErrorConditionT Connection::sendSuspend(
+    client::Engine &_rengine,
+    std::shared_ptr<SuspendNotification> const &_rmsg_ptr
+){
+    d.rserver.push(Server::Task(Server::Task::Suspend, d, _rengine, EventsNotificationPointerT(), _rmsg_ptr->suspend));
+    return solid::ErrorConditionT();
+}
+
+void Connection::closeConnection(client::Engine &_rengine){
+    d.rserver.push(Server::Task(Server::Task::Close, d, _rengine));
+}
+
+}//namespace loopback
+}//namespace bubbles
@@ -0,0 +1,64 @@
+#ifndef BUBBLES_LOOPBACK_HPP
+#define BUBBLES_LOOPBACK_HPP
+
+#include "client/engine/bubbles_client_engine.hpp"
+#include "server/main/src/bubbles_server_engine.hpp"
+
+namespace bubbles{
+namespace loopback{
+
+//In-process loopback between client Engines and a server Engine - no sockets, no TLS, no serialization.
+//The server Engine runs on a thread of its own, the way the server runs it on a single aio thread,
+//and every client Engine is connected to it through a Connection (a client::Transport).
+//Messages are copied at every hop, like a deserializer would, so no side ever sees the other's objects.
+class Server{
+public:
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    Server(const server::EngineConfiguration &_rcfg);
+    //close every Connection first - the pending work is completed before the thread exits
+    ~Server();
+
+    //server Engine calls made so far (registrations, received messages, deliveries ...)
+    uint64_t callCount()const;
+private:
+    friend class Connection;
+    struct Task;
+    void push(Task &&_utask);
+private:
+    struct Data;
+    Data    &d;
+};
+
+//a client Engine's connection to a loopback Server - give it to client::Engine::create;
+//it must outlive the engine and must be used by a single engine
+class Connection: public client::Transport{
+public:
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    Connection(Server &_rserver);
+    ~Connection();
+
+    solid::ErrorConditionT sendEvents(
+        client::Engine &_rengine,
+        std::shared_ptr<EventsNotification> const &_rmsg_ptr
+    ) override;
+
+    solid::ErrorConditionT sendSuspend(
+        client::Engine &_rengine,
+        std::shared_ptr<SuspendNotification> const &_rmsg_ptr
+    ) override;
+
+    void closeConnection(client::Engine &_rengine) override;
+private:
+    friend class Server;
+    struct Data;
+    Data    &d;
+};
+
+}//namespace loopback
+}//namespace bubbles
+
+#endif
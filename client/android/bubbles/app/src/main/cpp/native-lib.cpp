@@ -24,6 +24,7 @@
 #include "solid/frame/mpipc/mpipccompression_snappy.hpp"
 
 #include "client/engine/bubbles_client_engine.hpp"
+#include "client/engine/bubbles_client_message_setup.hpp"
 #include "protocol/bubbles_messages.hpp"
 
 using namespace std;
@@ -86,90 +87,6 @@ namespace {
 }//namespace
 
 
-//-----------------------------------------------------------------------------
-namespace bubbles{
-    namespace client{
-
-        struct MessageSetup {
-            Engine &engine;
-
-            MessageSetup(Engine &_engine):engine(_engine){}
-            
-            void operator()(bubbles::ProtocolT& _rprotocol, TypeToType<RegisterRequest> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
-            {
-                Engine &eng = engine;
-                auto lambda = [&eng](
-                    frame::mpipc::ConnectionContext &_rctx,
-                    std::shared_ptr<RegisterRequest> &_rsent_msg_ptr,
-                    std::shared_ptr<RegisterResponse> &_rrecv_msg_ptr,
-                    ErrorConditionT const &_rerror
-                ){
-                    eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
-                };
-                _rprotocol.registerMessage<RegisterRequest>(lambda, _rtid);
-            }
-            
-            void operator()(bubbles::ProtocolT& _rprotocol, TypeToType<RegisterResponse> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
-            {
-                Engine &eng = engine;
-                auto lambda = [&eng](
-                    frame::mpipc::ConnectionContext &_rctx,
-                    std::shared_ptr<RegisterRequest> &_rsent_msg_ptr,
-                    std::shared_ptr<RegisterResponse> &_rrecv_msg_ptr,
-                    ErrorConditionT const &_rerror
-                ){
-                    eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
-                };
-                _rprotocol.registerMessage<RegisterResponse>(lambda, _rtid);
-            }
-            
-            void operator()(bubbles::ProtocolT& _rprotocol, TypeToType<EventsNotificationRequest> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
-            {
-                Engine &eng = engine;
-                auto lambda = [&eng](
-                    frame::mpipc::ConnectionContext &_rctx,
-                    std::shared_ptr<EventsNotificationRequest> &_rsent_msg_ptr,
-                    std::shared_ptr<EventsNotificationResponse> &_rrecv_msg_ptr,
-                    ErrorConditionT const &_rerror
-                ){
-                    eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
-                };
-                _rprotocol.registerMessage<EventsNotificationRequest>(lambda, _rtid);
-            }
-            
-            void operator()(bubbles::ProtocolT& _rprotocol, TypeToType<EventsNotificationResponse> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
-            {
-                Engine &eng = engine;
-                auto lambda = [&eng](
-                    frame::mpipc::ConnectionContext &_rctx,
-                    std::shared_ptr<EventsNotificationRequest> &_rsent_msg_ptr,
-                    std::shared_ptr<EventsNotificationResponse> &_rrecv_msg_ptr,
-                    ErrorConditionT const &_rerror
-                ){
-                    eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
-                };
-                _rprotocol.registerMessage<EventsNotificationResponse>(lambda, _rtid);
-            }
-            
-            template <typename T>
-            void operator()(bubbles::ProtocolT& _rprotocol, TypeToType<T> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
-            {
-                Engine &eng = engine;
-                auto lambda = [&eng](
-                    frame::mpipc::ConnectionContext &_rctx,
-                    std::shared_ptr<T> &_rsent_msg_ptr,
-                    std::shared_ptr<T> &_rrecv_msg_ptr,
-                    ErrorConditionT const &_rerror
-                ){
-                    eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
-                };
-                _rprotocol.registerMessage<T>(lambda, _rtid);
-            }
-        };
-
-    }//namespace client
-}//namespace bubbles
-
 //-----------------------------------------------------------------------------
 
 extern "C"
@@ -244,7 +161,17 @@ jboolean Java_com_example_vapa_bubbles_BubblesActivity_nativeStart(
 
     LOGI("native start %s secure %d auto_pilot %d", g_ctx.endpoint.c_str(), (int)(_secure == JNI_TRUE), (int)(_auto_pilot == JNI_TRUE));
 
-    g_ctx.engine_ptr = bubbles::client::Engine::create(g_ctx.svc, g_ctx.ipcsvc, bubbles::client::EngineConfiguration{});
+    {
+        bubbles::client::EngineConfiguration engine_cfg;
+
+        //fewer, bigger messages - spare the radio wakeups
+        engine_cfg.move_min_distance = 16;
+        engine_cfg.move_min_interval_msec = 16;
+        engine_cfg.send_window_size = 2;
+        engine_cfg.send_batch_interval_msec = 50;
+
+        g_ctx.engine_ptr = bubbles::client::Engine::create(g_ctx.svc, g_ctx.ipcsvc, engine_cfg);
+    }
 
     ErrorConditionT         err;
     auto thr_enter = []() {
@@ -398,6 +325,15 @@ jboolean Java_com_example_vapa_bubbles_BubblesActivity_nativeMove(
     return JNI_TRUE;
 }
 
+extern "C"
+jboolean Java_com_example_vapa_bubbles_BubblesActivity_nativeMoveEnd(
+        JNIEnv *env,
+        jobject _this, jint _x, jint _y){
+
+    g_ctx.engine_ptr->moveEvent(_x, _y, true);
+    return JNI_TRUE;
+}
+
 extern "C"
 jint Java_com_example_vapa_bubbles_BubblesActivity_nativeScaleX(
         JNIEnv *env,
@@ -480,6 +416,33 @@ void Java_com_example_vapa_bubbles_BubblesActivity_nativePlotNext(JNIEnv *env, j
     ++g_ctx.plotit;
 }
 
+extern "C"
+jint Java_com_example_vapa_bubbles_BubblesActivity_nativeMyColor(JNIEnv *env, jobject _this){
+    return java_color(g_ctx.engine_ptr->myRgbColor());
+}
+
+//fill a direct ByteBuffer (native order) with {x, y, color} int triplets, already scaled
+//returns the number of plotted peers - when bigger than the buffer capacity, only the ones fitting were copied
+extern "C"
+jint Java_com_example_vapa_bubbles_BubblesActivity_nativePlotCopy(JNIEnv *env, jobject _this, jobject _buf, jint _w, jint _h){
+    static_assert(sizeof(bubbles::client::PlotEntry) == 3 * sizeof(jint), "PlotEntry must map on three java ints");
+
+    bubbles::client::PlotEntry  *pentries = static_cast<bubbles::client::PlotEntry*>(env->GetDirectBufferAddress(_buf));
+    const jlong                 buf_size = env->GetDirectBufferCapacity(_buf);
+
+    if(pentries == nullptr or buf_size < 0){
+        return 0;
+    }
+
+    const size_t capacity = buf_size / sizeof(bubbles::client::PlotEntry);
+    const size_t count = g_ctx.engine_ptr->plotCopy(pentries, capacity, _w, _h);
+
+    for(size_t i = 0; i < count and i < capacity; ++i){
+        pentries[i].rgb_color = java_color(pentries[i].rgb_color);
+    }
+    return count;
+}
+
 
 namespace {
     void exit_callback(){
@@ -123,6 +123,7 @@ public class BubblesActivity extends AppCompatActivity {
     public native boolean nativeResume();
 
     public native void nativeMove(int _x, int _y);
+    public native void nativeMoveEnd(int _x, int _y);
 
     public native void nativePlotStart();
     public native boolean nativePlotEnd();
@@ -132,6 +133,8 @@ public class BubblesActivity extends AppCompatActivity {
     public native int nativePlotMyColor();
     public native void nativePlotDone();
     public native void nativePlotNext();
+    public native int nativeMyColor();
+    public native int nativePlotCopy(java.nio.ByteBuffer _buf, int _w, int _h);
     public native int nativeScaleX(int _x, int _w);
     public native int nativeScaleY(int _y, int _h);
     public native int nativeReverseScaleX(int _x, int _w);
@@ -11,6 +11,10 @@ import android.util.AttributeSet;
 import android.view.MotionEvent;
 import android.view.View;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
+
 /**
  * TODO: document your custom view class.
  */
@@ -24,6 +28,11 @@ public class BubblesView extends View {
     private int gui_pointer_x = 0;
     private int gui_pointer_y = 0;
 
+    //{x, y, color} per plotted peer, filled by native code in one call per frame
+    private static final int PLOT_ENTRY_SIZE = 3 * 4;
+    private ByteBuffer plot_buf = allocatePlotBuffer(256);
+    private IntBuffer plot_ints = plot_buf.asIntBuffer();
+
     public BubblesView(Context context) {
         super(context);
         init(null, 0);
@@ -72,33 +81,47 @@ public class BubblesView extends View {
 
     }
 
+    private static ByteBuffer allocatePlotBuffer(int _capacity){
+        return ByteBuffer.allocateDirect(_capacity * PLOT_ENTRY_SIZE).order(ByteOrder.nativeOrder());
+    }
+
     @Override
     protected void onDraw(Canvas canvas) {
         super.onDraw(canvas);
         getPointerPos();
-        activity.nativePlotStart();
-        int my_color = activity.nativePlotMyColor();
+        int my_color = activity.nativeMyColor();
+        int capacity = plot_buf.capacity() / PLOT_ENTRY_SIZE;
+        int count = activity.nativePlotCopy(plot_buf, this.getWidth(), this.getHeight());
+
+        if(count > capacity){
+            //grow and copy again - the plot might have changed meanwhile
+            plot_buf = allocatePlotBuffer(count * 2);
+            plot_ints = plot_buf.asIntBuffer();
+            capacity = plot_buf.capacity() / PLOT_ENTRY_SIZE;
+            count = Math.min(activity.nativePlotCopy(plot_buf, this.getWidth(), this.getHeight()), capacity);
+        }
 
         canvas.translate(canvas.getWidth()/2, canvas.getHeight()/2);
 
-        while(!activity.nativePlotEnd()) {
-            int x = activity.nativePlotX();
-            int y = activity.nativePlotY();
-            int c = activity.nativePlotColor();
-
-            drawCircle(canvas, x, y, c, 10);
+        for(int i = 0; i < count; ++i) {
+            int x = plot_ints.get(3 * i);
+            int y = plot_ints.get(3 * i + 1);
+            int c = plot_ints.get(3 * i + 2);
 
-            activity.nativePlotNext();
+            drawScaledCircle(canvas, x, y, c, 10);
         }
-        activity.nativePlotDone();
         drawCircle(canvas, gui_pointer_x, gui_pointer_y, my_color, 20);
     }
 
     void drawCircle(Canvas canvas, int x, int y, int c, int r){
-        mCirclePaint.setColor(c);
         int nx = activity.nativeScaleX(x, this.getWidth());
         int ny = activity.nativeScaleY(y, this.getHeight());
-        canvas.drawCircle(nx, ny, r, mCirclePaint);
+        drawScaledCircle(canvas, nx, ny, c, r);
+    }
+
+    void drawScaledCircle(Canvas canvas, int x, int y, int c, int r){
+        mCirclePaint.setColor(c);
+        canvas.drawCircle(x, y, r, mCirclePaint);
     }
 
     @Override
@@ -163,7 +186,7 @@ public class BubblesView extends View {
 
                 int x = activity.nativeReverseScaleX((int)(event.getX(0) - this.getWidth()/2), this.getWidth());
                 int y = activity.nativeReverseScaleY((int)(event.getY(0) - this.getHeight()/2), this.getHeight());
-                activity.nativeMove(x, y);
+                activity.nativeMoveEnd(x, y);
                 setPointerPos(x, y);
 
                 mHasTouch = false;
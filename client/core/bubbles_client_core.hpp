@@ -0,0 +1,116 @@
+#ifndef BUBBLES_CLIENT_CORE_HPP
+#define BUBBLES_CLIENT_CORE_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+//Headless bubbles client: the Engine together with all it needs to run -
+//schedulers, resolver, mpipc configuration, TLS and Snappy - behind a C API.
+//
+//A context holds the threads and can be shared by many clients.
+//Every client has its own connection to the server and its own engine.
+//Destroy all the clients of a context before destroying the context.
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+    typedef struct BubblesContext BubblesContext;
+    typedef struct BubblesClient BubblesClient;
+    typedef struct BubblesLatencyHistogram BubblesLatencyHistogram;
+
+    typedef void (*BubblesCallbackT)(void*);
+
+    typedef struct{
+        int32_t     x;
+        int32_t     y;
+        uint32_t    rgb_color;
+    } BubblesPlotEntry;
+
+    typedef struct{
+        const char  *endpoint;//server address:port
+        const char  *room;
+        uint32_t    rgb_color;//requested color - 0 lets the server choose
+        int         secure;
+        int         compress;
+        int         auto_pilot;//move the bubble around on its own
+        int         suspend_on_pause;//0 - pause closes the connection
+        int         probe;//stamp the moves so that peers in the same process/host can measure the latency
+        //TLS - either PEM content or file paths; PEM content is used when set
+        const char  *ssl_verify_authority;
+        const char  *ssl_client_cert;
+        const char  *ssl_client_key;
+        const char  *ssl_verify_authority_file;
+        const char  *ssl_client_cert_file;
+        const char  *ssl_client_key_file;
+        //see bubbles::client::EngineConfiguration
+        size_t      move_min_distance;
+        size_t      move_min_interval_msec;
+        size_t      send_window_size;
+        size_t      send_batch_interval_msec;
+        size_t      keepalive_timeout_seconds;
+    } BubblesClientConfig;
+
+    //cumulative counters - see bubbles::client::EngineStatistics
+    typedef struct{
+        uint64_t    sent_message_count;
+        uint64_t    sent_event_count;
+        uint64_t    received_message_count;
+        uint64_t    received_event_count;
+        uint64_t    dropped_event_count;
+        uint64_t    connection_stop_count;
+        //outgoing packet payload as measured by the compressor - only counted with compress on
+        uint64_t    sent_byte_count;
+    } BubblesClientStatistics;
+
+    //fill in the defaults used by the desktop client
+    void bubbles_client_config_init(BubblesClientConfig *_pcfg);
+
+    BubblesContext* bubbles_context_create(const int _aio_thread_count, const int _thread_count);
+    void bubbles_context_destroy(BubblesContext *_pctx);
+
+    //returns nullptr on error
+    BubblesClient* bubbles_client_create(BubblesContext *_pctx, const BubblesClientConfig *_pcfg);
+    void bubbles_client_destroy(BubblesClient *_pcli);
+
+    //callbacks are called on the engine's thread and must be set before bubbles_client_start
+    void bubbles_client_set_exit_callback(BubblesClient *_pcli, void *_pdata, BubblesCallbackT _fnc);
+    void bubbles_client_set_gui_update_callback(BubblesClient *_pcli, void *_pdata, BubblesCallbackT _fnc);
+    //when not set, an auto pilot client moves its bubble by itself
+    void bubbles_client_set_auto_update_callback(BubblesClient *_pcli, void *_pdata, BubblesCallbackT _fnc);
+
+    //returns 0 on success
+    int bubbles_client_start(BubblesClient *_pcli);
+
+    void bubbles_client_pause(BubblesClient *_pcli);
+    void bubbles_client_resume(BubblesClient *_pcli);
+
+    void bubbles_client_move(BubblesClient *_pcli, const int _x, const int _y);
+    void bubbles_client_move_end(BubblesClient *_pcli, const int _x, const int _y);
+    void bubbles_client_auto_position(BubblesClient *_pcli, int *_px, int *_py);
+
+    uint32_t bubbles_client_my_color(BubblesClient *_pcli);
+    //copy at most _capacity entries of the plot scaled to a _w x _h viewport
+    //returns the number of plotted peers which can exceed _capacity
+    size_t bubbles_client_plot_copy(BubblesClient *_pcli, BubblesPlotEntry *_pentries, const size_t _capacity, const int _w, const int _h);
+
+    void bubbles_client_statistics(BubblesClient *_pcli, BubblesClientStatistics *_pstatistics);
+
+    //one-way latency of the probe moves received, in microseconds - see bubbles::LatencyHistogram
+    BubblesLatencyHistogram* bubbles_latency_histogram_create(void);
+    void bubbles_latency_histogram_destroy(BubblesLatencyHistogram *_phist);
+    void bubbles_latency_histogram_clear(BubblesLatencyHistogram *_phist);
+    void bubbles_latency_histogram_merge(BubblesLatencyHistogram *_phist, const BubblesLatencyHistogram *_pother);
+    uint64_t bubbles_latency_histogram_count(const BubblesLatencyHistogram *_phist);
+    uint64_t bubbles_latency_histogram_max(const BubblesLatencyHistogram *_phist);
+    //e.g. 99.9 for p999
+    uint64_t bubbles_latency_histogram_percentile(const BubblesLatencyHistogram *_phist, const double _percent);
+
+    //move the samples the client gathered since the last call into _phist
+    void bubbles_client_collect_latency(BubblesClient *_pcli, BubblesLatencyHistogram *_phist);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
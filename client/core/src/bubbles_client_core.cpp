@@ -0,0 +1,384 @@
+#include "client/core/bubbles_client_core.hpp"
+
+#include "solid/system/log.hpp"
+#include "solid/frame/manager.hpp"
+#include "solid/frame/scheduler.hpp"
+#include "solid/frame/service.hpp"
+#include "solid/frame/reactor.hpp"
+
+#include "solid/frame/aio/aioreactor.hpp"
+#include "solid/frame/aio/aioresolver.hpp"
+
+#include "solid/frame/aio/openssl/aiosecurecontext.hpp"
+#include "solid/frame/aio/openssl/aiosecuresocket.hpp"
+
+#include "solid/frame/mpipc/mpipcservice.hpp"
+#include "solid/frame/mpipc/mpipcconfiguration.hpp"
+#include "solid/frame/mpipc/mpipcsocketstub_openssl.hpp"
+#include "solid/frame/mpipc/mpipccompression_snappy.hpp"
+
+#include "client/engine/bubbles_client_engine.hpp"
+#include "client/engine/bubbles_client_message_setup.hpp"
+#include "protocol/bubbles_messages.hpp"
+#include "protocol/bubbles_compress_counter.hpp"
+
+#include <string>
+#include <atomic>
+
+using namespace std;
+using namespace solid;
+
+namespace{
+    using AioSchedulerT = frame::Scheduler<frame::aio::Reactor>;
+    using SchedulerT = frame::Scheduler<frame::Reactor>;
+    using EnginePointerT = bubbles::client::Engine::PointerT;
+
+    string make_string(const char *_str){
+        return _str ? string(_str) : string();
+    }
+
+    //the port used by the resolver when the endpoint has none
+    string endpoint_port(const string &_endpoint){
+        const size_t pos = _endpoint.rfind(':');
+        return pos == string::npos ? string("4444") : _endpoint.substr(pos + 1);
+    }
+}//namespace
+
+struct BubblesLatencyHistogram: bubbles::LatencyHistogram{
+};
+
+struct BubblesContext{
+    BubblesContext(){}
+
+    frame::Manager          manager;
+    AioSchedulerT           aio_sch;
+    SchedulerT              sch;
+    frame::aio::Resolver    resolver;
+};
+
+struct BubblesClient{
+    BubblesClient(
+        BubblesContext &_rctx, const BubblesClientConfig &_rcfg
+    ):  rctx(_rctx), svc(_rctx.manager), ipcsvc(_rctx.manager),
+        endpoint(make_string(_rcfg.endpoint)), room(make_string(_rcfg.room)),
+        rgb_color(_rcfg.rgb_color), secure(_rcfg.secure != 0), compress(_rcfg.compress != 0), auto_pilot(_rcfg.auto_pilot != 0),
+        keepalive_timeout_seconds(_rcfg.keepalive_timeout_seconds),
+        ssl_verify_authority(make_string(_rcfg.ssl_verify_authority)),
+        ssl_client_cert(make_string(_rcfg.ssl_client_cert)),
+        ssl_client_key(make_string(_rcfg.ssl_client_key)),
+        ssl_verify_authority_file(make_string(_rcfg.ssl_verify_authority_file)),
+        ssl_client_cert_file(make_string(_rcfg.ssl_client_cert_file)),
+        ssl_client_key_file(make_string(_rcfg.ssl_client_key_file)),
+        started(false)
+    {
+        bubbles::client::EngineConfiguration engine_cfg;
+
+        engine_cfg.suspend_on_pause = _rcfg.suspend_on_pause != 0;
+        engine_cfg.probe = _rcfg.probe != 0;
+        engine_cfg.move_min_distance = _rcfg.move_min_distance;
+        engine_cfg.move_min_interval_msec = _rcfg.move_min_interval_msec;
+        engine_cfg.send_window_size = _rcfg.send_window_size;
+        engine_cfg.send_batch_interval_msec = _rcfg.send_batch_interval_msec;
+
+        engine_ptr = bubbles::client::Engine::create(svc, ipcsvc, engine_cfg);
+    }
+
+    ErrorConditionT configure();
+
+    BubblesContext          &rctx;
+    bubbles::ByteCounters   byte_counters;//outgoing payload as measured by the compressor - before ipcsvc, which uses it
+    frame::ServiceT         svc;
+    frame::mpipc::ServiceT  ipcsvc;
+    EnginePointerT          engine_ptr;
+    string                  endpoint;
+    string                  room;
+    uint32_t                rgb_color;
+    bool                    secure;
+    bool                    compress;
+    bool                    auto_pilot;
+    size_t                  keepalive_timeout_seconds;
+    string                  ssl_verify_authority;
+    string                  ssl_client_cert;
+    string                  ssl_client_key;
+    string                  ssl_verify_authority_file;
+    string                  ssl_client_cert_file;
+    string                  ssl_client_key_file;
+    bool                    started;
+};
+
+ErrorConditionT BubblesClient::configure(){
+    const string                port = endpoint_port(endpoint);
+    auto                        proto = bubbles::ProtocolT::create();
+    frame::mpipc::Configuration cfg(rctx.aio_sch, proto);
+
+    bubbles::protocol_setup(bubbles::client::MessageSetup(std::ref(*engine_ptr)), *proto);
+
+    cfg.limitString(256);
+    cfg.limitContainer(256);
+    cfg.limitStream(0);
+
+    cfg.client.name_resolve_fnc = frame::mpipc::InternetResolverF(rctx.resolver, port.c_str());
+
+    cfg.client.connection_start_state = frame::mpipc::ConnectionState::Passive;
+
+    cfg.connection_keepalive_timeout_seconds = keepalive_timeout_seconds;
+
+    {
+        EnginePointerT  eng_ptr = engine_ptr;
+        auto connection_stop_lambda = [eng_ptr](frame::mpipc::ConnectionContext &_ctx){
+            eng_ptr->onConnectionStop(_ctx);
+        };
+        auto connection_start_lambda = [eng_ptr](frame::mpipc::ConnectionContext &_ctx){
+            eng_ptr->onConnectionStart(_ctx);
+        };
+        cfg.connection_stop_fnc = std::move(connection_stop_lambda);
+        cfg.client.connection_start_fnc = std::move(connection_start_lambda);
+    }
+
+    if(secure){
+        const string verify_authority = ssl_verify_authority;
+        const string client_cert = ssl_client_cert;
+        const string client_key = ssl_client_key;
+        const string verify_authority_file = ssl_verify_authority_file;
+        const string client_cert_file = ssl_client_cert_file;
+        const string client_key_file = ssl_client_key_file;
+
+        frame::mpipc::openssl::setup_client(
+            cfg,
+            [=](frame::aio::openssl::Context &_rctx) -> ErrorCodeT{
+                if(verify_authority.size()){
+                    _rctx.addVerifyAuthority(verify_authority);
+                }else{
+                    _rctx.loadVerifyFile(verify_authority_file.c_str());
+                }
+                if(client_cert.size()){
+                    _rctx.loadCertificate(client_cert);
+                }else{
+                    _rctx.loadCertificateFile(client_cert_file.c_str());
+                }
+                if(client_key.size()){
+                    _rctx.loadPrivateKey(client_key);
+                }else{
+                    _rctx.loadPrivateKeyFile(client_key_file.c_str());
+                }
+                return ErrorCodeT();
+            },
+            frame::mpipc::openssl::NameCheckSecureStart{"bubbles-server"}
+        );
+    }
+
+    if(compress){
+        frame::mpipc::snappy::setup(cfg);
+        bubbles::count_sent_bytes(cfg, byte_counters);
+    }
+
+    return ipcsvc.reconfigure(std::move(cfg));
+}
+
+//-----------------------------------------------------------------------------
+
+void bubbles_client_config_init(BubblesClientConfig *_pcfg){
+    bubbles::client::EngineConfiguration engine_cfg;
+
+    _pcfg->endpoint = "localhost:4444";
+    _pcfg->room = "test";
+    _pcfg->rgb_color = 0;
+    _pcfg->secure = 1;
+    _pcfg->compress = 1;
+    _pcfg->auto_pilot = 0;
+    _pcfg->suspend_on_pause = engine_cfg.suspend_on_pause ? 1 : 0;
+    _pcfg->probe = 0;
+    _pcfg->ssl_verify_authority = nullptr;
+    _pcfg->ssl_client_cert = nullptr;
+    _pcfg->ssl_client_key = nullptr;
+    _pcfg->ssl_verify_authority_file = "bubbles-ca-cert.pem";
+    _pcfg->ssl_client_cert_file = "bubbles-client-cert.pem";
+    _pcfg->ssl_client_key_file = "bubbles-client-key.pem";
+    _pcfg->move_min_distance = engine_cfg.move_min_distance;
+    _pcfg->move_min_interval_msec = engine_cfg.move_min_interval_msec;
+    _pcfg->send_window_size = engine_cfg.send_window_size;
+    _pcfg->send_batch_interval_msec = engine_cfg.send_batch_interval_msec;
+    _pcfg->keepalive_timeout_seconds = 30;
+}
+
+BubblesContext* bubbles_context_create(const int _aio_thread_count, const int _thread_count){
+    BubblesContext  *pctx = new BubblesContext;
+    ErrorConditionT err;
+
+    err = pctx->aio_sch.start(_aio_thread_count > 0 ? _aio_thread_count : 1);
+
+    if(err){
+        solid_log(generic_logger, Error, "Error starting aio scheduler: "<<err.message());
+        delete pctx;
+        return nullptr;
+    }
+
+    err = pctx->resolver.start(1);
+
+    if(err){
+        solid_log(generic_logger, Error, "Error starting aio resolver: "<<err.message());
+        pctx->aio_sch.stop();
+        delete pctx;
+        return nullptr;
+    }
+
+    err = pctx->sch.start(_thread_count > 0 ? _thread_count : 1);
+
+    if(err){
+        solid_log(generic_logger, Error, "Error starting scheduler: "<<err.message());
+        pctx->resolver.stop();
+        pctx->aio_sch.stop();
+        delete pctx;
+        return nullptr;
+    }
+    return pctx;
+}
+
+void bubbles_context_destroy(BubblesContext *_pctx){
+    if(_pctx){
+        _pctx->manager.stop();
+        _pctx->sch.stop();
+        _pctx->aio_sch.stop();
+        _pctx->resolver.stop();
+        delete _pctx;
+    }
+}
+
+BubblesClient* bubbles_client_create(BubblesContext *_pctx, const BubblesClientConfig *_pcfg){
+    if(_pctx == nullptr or _pcfg == nullptr){
+        return nullptr;
+    }
+    BubblesClient *pcli = new BubblesClient(*_pctx, *_pcfg);
+
+    //the engine calls all of them - make sure none is empty
+    pcli->engine_ptr->setExitFunction([](){});
+    pcli->engine_ptr->setGuiUpdateFunction([](){});
+
+    bubbles::client::Engine *peng = pcli->engine_ptr.get();
+    pcli->engine_ptr->setAutoUpdateFunction(
+        [peng](){
+            int x, y;
+            peng->getAutoPosition(x, y);
+            peng->moveEvent(x, y);
+        }
+    );
+
+    ErrorConditionT err = pcli->configure();
+
+    if(err){
+        solid_log(generic_logger, Error, "Error configuring ipcservice: "<<err.message());
+        delete pcli;
+        return nullptr;
+    }
+    return pcli;
+}
+
+void bubbles_client_destroy(BubblesClient *_pcli){
+    if(_pcli){
+        //the connection first - its callbacks use the engine
+        _pcli->ipcsvc.stop();
+        _pcli->svc.stop();
+        delete _pcli;
+    }
+}
+
+void bubbles_client_set_exit_callback(BubblesClient *_pcli, void *_pdata, BubblesCallbackT _fnc){
+    _pcli->engine_ptr->setExitFunction([_pdata, _fnc](){_fnc(_pdata);});
+}
+
+void bubbles_client_set_gui_update_callback(BubblesClient *_pcli, void *_pdata, BubblesCallbackT _fnc){
+    _pcli->engine_ptr->setGuiUpdateFunction([_pdata, _fnc](){_fnc(_pdata);});
+}
+
+void bubbles_client_set_auto_update_callback(BubblesClient *_pcli, void *_pdata, BubblesCallbackT _fnc){
+    _pcli->engine_ptr->setAutoUpdateFunction([_pdata, _fnc](){_fnc(_pdata);});
+}
+
+int bubbles_client_start(BubblesClient *_pcli){
+    if(_pcli->started){
+        return 0;
+    }
+    ErrorConditionT err = _pcli->engine_ptr->start(_pcli->rctx.sch, _pcli->endpoint, _pcli->room, _pcli->auto_pilot, _pcli->rgb_color);
+
+    if(err){
+        solid_log(generic_logger, Error, "Error starting engine: "<<err.message());
+        return -1;
+    }
+    _pcli->started = true;
+    return 0;
+}
+
+void bubbles_client_pause(BubblesClient *_pcli){
+    _pcli->engine_ptr->pause();
+}
+
+void bubbles_client_resume(BubblesClient *_pcli){
+    _pcli->engine_ptr->resume();
+}
+
+void bubbles_client_move(BubblesClient *_pcli, const int _x, const int _y){
+    _pcli->engine_ptr->moveEvent(_x, _y);
+}
+
+void bubbles_client_move_end(BubblesClient *_pcli, const int _x, const int _y){
+    _pcli->engine_ptr->moveEvent(_x, _y, true);
+}
+
+void bubbles_client_auto_position(BubblesClient *_pcli, int *_px, int *_py){
+    _pcli->engine_ptr->getAutoPosition(*_px, *_py);
+}
+
+uint32_t bubbles_client_my_color(BubblesClient *_pcli){
+    return _pcli->engine_ptr->myRgbColor();
+}
+
+size_t bubbles_client_plot_copy(BubblesClient *_pcli, BubblesPlotEntry *_pentries, const size_t _capacity, const int _w, const int _h){
+    static_assert(sizeof(BubblesPlotEntry) == sizeof(bubbles::client::PlotEntry), "BubblesPlotEntry must map on PlotEntry");
+    return _pcli->engine_ptr->plotCopy(reinterpret_cast<bubbles::client::PlotEntry*>(_pentries), _capacity, _w, _h);
+}
+
+void bubbles_client_statistics(BubblesClient *_pcli, BubblesClientStatistics *_pstatistics){
+    bubbles::client::EngineStatistics   statistics;
+
+    _pcli->engine_ptr->statistics(statistics);
+
+    _pstatistics->sent_message_count = statistics.sent_message_count;
+    _pstatistics->sent_event_count = statistics.sent_event_count;
+    _pstatistics->received_message_count = statistics.received_message_count;
+    _pstatistics->received_event_count = statistics.received_event_count;
+    _pstatistics->dropped_event_count = statistics.dropped_event_count;
+    _pstatistics->connection_stop_count = statistics.connection_stop_count;
+    _pstatistics->sent_byte_count = _pcli->byte_counters.compressed_byte_count.load(std::memory_order_relaxed);
+}
+
+BubblesLatencyHistogram* bubbles_latency_histogram_create(void){
+    return new BubblesLatencyHistogram;
+}
+
+void bubbles_latency_histogram_destroy(BubblesLatencyHistogram *_phist){
+    delete _phist;
+}
+
+void bubbles_latency_histogram_clear(BubblesLatencyHistogram *_phist){
+    _phist->clear();
+}
+
+void bubbles_latency_histogram_merge(BubblesLatencyHistogram *_phist, const BubblesLatencyHistogram *_pother){
+    _phist->merge(*_pother);
+}
+
+uint64_t bubbles_latency_histogram_count(const BubblesLatencyHistogram *_phist){
+    return _phist->count();
+}
+
+uint64_t bubbles_latency_histogram_max(const BubblesLatencyHistogram *_phist){
+    return _phist->max();
+}
+
+uint64_t bubbles_latency_histogram_percentile(const BubblesLatencyHistogram *_phist, const double _percent){
+    return _phist->percentile(_percent);
+}
+
+void bubbles_client_collect_latency(BubblesClient *_pcli, BubblesLatencyHistogram *_phist){
+    _pcli->engine_ptr->collectLatency(*_phist);
+}
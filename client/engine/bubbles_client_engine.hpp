@@ -2,6 +2,8 @@
 #define BUBBLES_CLIENT_ENGINE_HPP
 
 #include "protocol/bubbles_messages.hpp"
+#include "protocol/bubbles_latency_histogram.hpp"
+#include "client/engine/bubbles_client_viewport.hpp"
 #include "solid/frame/object.hpp"
 #include "solid/frame/scheduler.hpp"
 #include "solid/frame/reactor.hpp"
@@ -21,13 +23,78 @@ namespace client{
 
 using SchedulerT = solid::frame::Scheduler<solid::frame::Reactor>;
 
+//what the engine does with the incoming backlog once it lags behind real time
+enum class CatchUpE{
+    None,       //replay every sample - one per peer per pass
+    Collapse,   //jump every peer straight to its latest sample
+    Accelerate, //replay only every catch_up_step-th sample of every peer
+};
+
 struct EngineConfiguration{
-    EngineConfiguration(): max_event_queue_size(1024){}
+    EngineConfiguration(
+    ):  max_event_queue_size(1024), move_min_distance(0), move_min_interval_msec(16),
+        send_window_size(4), send_batch_interval_msec(0), suspend_on_pause(true), probe(false),
+        catch_up(CatchUpE::Collapse),
+        catch_up_max_lag_msec(500), catch_up_max_backlog(4096), catch_up_step(4){}
+
     size_t      max_event_queue_size;
+    size_t      move_min_distance;//moveEvent drops samples closer than this (canvas units) to the last kept one - 0 to disable
+    size_t      move_min_interval_msec;//moveEvent drops samples sooner than this after the last kept one - 0 to disable
+    size_t      send_window_size;//maximum EventsNotification messages in flight - one of them is acknowledged by the server
+    size_t      send_batch_interval_msec;//minimum time between two sends while the event queue is shallow - 0 means no batching
+    bool        suspend_on_pause;//on pause, keep the connection alive and only ask the server to stop streaming
+    bool        probe;//stamp every move with its send time so that the peers can measure the latency
+    CatchUpE    catch_up;
+    size_t      catch_up_max_lag_msec;//catch up when the oldest pending event stub is older than this
+    size_t      catch_up_max_backlog;//catch up when more than this many events are pending
+    size_t      catch_up_step;//used by CatchUpE::Accelerate
+};
+
+//cumulative engine counters - see Engine::statistics
+struct EngineStatistics{
+    EngineStatistics(
+    ):  sent_message_count(0), sent_event_count(0),
+        received_message_count(0), received_event_count(0),
+        dropped_event_count(0), connection_stop_count(0){}
+
+    uint64_t    sent_message_count;//EventsNotification messages the server was sent
+    uint64_t    sent_event_count;
+    uint64_t    received_message_count;//EventsNotification messages received from the server
+    uint64_t    received_event_count;//peer position samples received
+    uint64_t    dropped_event_count;//local samples dropped because the outgoing queue was full
+    uint64_t    connection_stop_count;
 };
 
 class Engine;
 
+//The engine's connection to the server.
+//By default the engine talks to the server through an mpipc service (see Engine::create);
+//benchmarks and tests plug in their own, e.g. an in-process loopback to a server Engine.
+//A transport reports back through the transport independent entry points of the Engine:
+//connectionStart, connectionRegistered, connectionStop, eventsReceived and eventsSent.
+class Transport{
+public:
+    virtual ~Transport(){}
+
+    //send _rmsg_ptr to the server, connecting first when there is no connection
+    //every accepted message must be given back through Engine::eventsSent - delivered or not;
+    //an EventsNotificationRequest is given back once the server acknowledged it (the engine
+    //paces its sends on that round trip) - or on error
+    virtual solid::ErrorConditionT sendEvents(
+        Engine &_rengine,
+        std::shared_ptr<EventsNotification> const &_rmsg_ptr
+    ) = 0;
+
+    //send _rmsg_ptr on the current connection only
+    virtual solid::ErrorConditionT sendSuspend(
+        Engine &_rengine,
+        std::shared_ptr<SuspendNotification> const &_rmsg_ptr
+    ) = 0;
+
+    //Engine::connectionStop follows
+    virtual void closeConnection(Engine &_rengine) = 0;
+};
+
 struct PlotIterator{
     PlotIterator(PlotIterator &&_plotit);
     PlotIterator();
@@ -52,14 +119,16 @@ struct PlotIterator{
 private:
     friend class Engine;
     PlotIterator(Engine &);
+    void skipEmpty();
 private:
     size_t      pos;
-    size_t      plotdq_index;
+    size_t      plotvec_index;
     uint32_t    rgb_color;
     Engine      *peng;
 };
 
 class Engine: public solid::Dynamic<Engine, solid::frame::Object>{
+    static constexpr int32_t plot_margin = 32;//viewport units - a bubble partially visible is still drawn
     using ExitFunctionT = std::function<void()>;
     using GuiUpdateFunctionT = std::function<void()>;
     using AutoUpdateFunctionT = std::function<void()>;
@@ -73,6 +142,14 @@ public:
         return PointerT(new Engine(_rsvc, _rmpipc, _cfg));
     }
 
+    //_rtransport must outlive the engine
+    static PointerT create(
+        solid::frame::ServiceT &_rsvc, Transport &_rtransport,
+        const EngineConfiguration &_cfg
+    ){
+        return PointerT(new Engine(_rsvc, _rtransport, _cfg));
+    }
+
     solid::ErrorConditionT start(
         SchedulerT &_rsched,
         const std::string &_server_endpoint,
@@ -115,9 +192,27 @@ public:
 
     PlotIterator plot();
 
+    //viewport showing the whole canvas in a _w x _h window
+    Viewport viewport(const int _w, const int _h)const;
+
+    //copy at most _capacity entries of the currently visible plot, transformed through _rviewport,
+    //into _pentries - returns the number of visible peers which can exceed _capacity
+    //only the peers within the grid cells overlapped by the viewport are visited
+    size_t plotCopy(PlotEntry *_pentries, const size_t _capacity, const Viewport &_rviewport);
+    size_t plotCopy(PlotEntry *_pentries, const size_t _capacity, const long _w, const long _h);
+
+    uint32_t myRgbColor()const;
+
+    void statistics(EngineStatistics &_rstatistics)const;
+
+    //merge the one-way latencies of the probe moves received since the last call into _rhistogram
+    void collectLatency(LatencyHistogram &_rhistogram);
+
     void getAutoPosition(int &_rx, int &_ry);
 
-    void moveEvent(int _x, int _y);
+    //_last marks the end of a gesture - such a sample is never dropped;
+    //a dropped sample with no newer one is still sent once the last kept one is move_min_interval_msec old
+    void moveEvent(int _x, int _y, const bool _last = false);
     void onConnectionStart(solid::frame::mpipc::ConnectionContext &_rctx);
     void onConnectionStop(solid::frame::mpipc::ConnectionContext &_rctx);
 
@@ -142,15 +237,42 @@ public:
         solid::ErrorConditionT const &_rerror
     );
 
+    void onMessage(
+        solid::frame::mpipc::ConnectionContext &_rctx,
+        std::shared_ptr<SuspendNotification> &_rsent_msg_ptr,
+        std::shared_ptr<SuspendNotification> &_rrecv_msg_ptr,
+        solid::ErrorConditionT const &_rerror
+    );
+
+    //transport independent entry points - the mpipc callbacks above forward to them
+    //and so must every other Transport; they can be called from any thread
+
+    //a connection to the server is up: fills in _rreq and returns true,
+    //or returns false when the engine is paused and the connection must be closed
+    bool connectionStart(RegisterRequest &_rreq);
+    //returns true when the connection was registered and can carry events
+    bool connectionRegistered(const RegisterResponse &_rres);
+    void connectionStop();
+
+    void eventsReceived(std::shared_ptr<EventsNotification> &_rmsg_ptr);
+    //the transport is done with a message given to Transport::sendEvents
+    //_round_trip - the server acknowledged the message, the time since it was sent is a round trip
+    void eventsSent(std::shared_ptr<EventsNotification> &_rmsg_ptr, const bool _round_trip = false);
+
 private:
     Engine(
         solid::frame::ServiceT &_rsvc, solid::frame::mpipc::Service &_rmpipc,
         const EngineConfiguration &_cfg
     );
+    Engine(
+        solid::frame::ServiceT &_rsvc, Transport &_rtransport,
+        const EngineConfiguration &_cfg
+    );
     ~Engine();
 
     void onEvent(solid::frame::ReactorContext &_rctx, solid::Event &&_uevent) override;
-    void doTrySendEvents();
+    void doTrySendEvents(solid::frame::ReactorContext &_rctx);
+    void doFlushMoveEvent(solid::frame::ReactorContext &_rctx);
 
     void doSetExitFunction(ExitFunctionT &&_uf);
     void doSetGuiUpdateFunction(GuiUpdateFunctionT &&_uf);
@@ -0,0 +1,92 @@
+#ifndef BUBBLES_CLIENT_MESSAGE_SETUP_HPP
+#define BUBBLES_CLIENT_MESSAGE_SETUP_HPP
+
+#include "client/engine/bubbles_client_engine.hpp"
+#include "solid/frame/mpipc/mpipcprotocol_serialization_v2.hpp"
+
+namespace bubbles{
+namespace client{
+
+//registers every protocol message with the Engine::onMessage handling it
+//use: bubbles::protocol_setup(MessageSetup(engine), *proto);
+struct MessageSetup {
+    Engine &engine;
+
+    MessageSetup(Engine &_engine):engine(_engine){}
+    
+    void operator()(bubbles::ProtocolT& _rprotocol, solid::TypeToType<RegisterRequest> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
+    {
+        Engine &eng = engine;
+        auto lambda = [&eng](
+            solid::frame::mpipc::ConnectionContext &_rctx,
+            std::shared_ptr<RegisterRequest> &_rsent_msg_ptr,
+            std::shared_ptr<RegisterResponse> &_rrecv_msg_ptr,
+            solid::ErrorConditionT const &_rerror
+        ){
+            eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
+        };
+        _rprotocol.registerMessage<RegisterRequest>(lambda, _rtid);
+    }
+    
+    void operator()(bubbles::ProtocolT& _rprotocol, solid::TypeToType<RegisterResponse> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
+    {
+        Engine &eng = engine;
+        auto lambda = [&eng](
+            solid::frame::mpipc::ConnectionContext &_rctx,
+            std::shared_ptr<RegisterRequest> &_rsent_msg_ptr,
+            std::shared_ptr<RegisterResponse> &_rrecv_msg_ptr,
+            solid::ErrorConditionT const &_rerror
+        ){
+            eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
+        };
+        _rprotocol.registerMessage<RegisterResponse>(lambda, _rtid);
+    }
+    
+    void operator()(bubbles::ProtocolT& _rprotocol, solid::TypeToType<EventsNotificationRequest> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
+    {
+        Engine &eng = engine;
+        auto lambda = [&eng](
+            solid::frame::mpipc::ConnectionContext &_rctx,
+            std::shared_ptr<EventsNotificationRequest> &_rsent_msg_ptr,
+            std::shared_ptr<EventsNotificationResponse> &_rrecv_msg_ptr,
+            solid::ErrorConditionT const &_rerror
+        ){
+            eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
+        };
+        _rprotocol.registerMessage<EventsNotificationRequest>(lambda, _rtid);
+    }
+    
+    void operator()(bubbles::ProtocolT& _rprotocol, solid::TypeToType<EventsNotificationResponse> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
+    {
+        Engine &eng = engine;
+        auto lambda = [&eng](
+            solid::frame::mpipc::ConnectionContext &_rctx,
+            std::shared_ptr<EventsNotificationRequest> &_rsent_msg_ptr,
+            std::shared_ptr<EventsNotificationResponse> &_rrecv_msg_ptr,
+            solid::ErrorConditionT const &_rerror
+        ){
+            eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
+        };
+        _rprotocol.registerMessage<EventsNotificationResponse>(lambda, _rtid);
+    }
+    
+    template <typename T>
+    void operator()(bubbles::ProtocolT& _rprotocol, solid::TypeToType<T> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
+    {
+        Engine &eng = engine;
+        auto lambda = [&eng](
+            solid::frame::mpipc::ConnectionContext &_rctx,
+            std::shared_ptr<T> &_rsent_msg_ptr,
+            std::shared_ptr<T> &_rrecv_msg_ptr,
+            solid::ErrorConditionT const &_rerror
+        ){
+            eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
+        };
+        _rprotocol.registerMessage<T>(lambda, _rtid);
+    }
+};
+
+}//namespace client
+}//namespace bubbles
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef BUBBLES_CLIENT_VIEWPORT_HPP
+#define BUBBLES_CLIENT_VIEWPORT_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+namespace bubbles{
+namespace client{
+
+//flat plot entry - filled in bulk by Engine::plotCopy
+struct PlotEntry{
+    int32_t     x;
+    int32_t     y;
+    uint32_t    rgb_color;
+};
+
+//Maps canvas coordinates onto a viewport (window) with the origin in the viewport center.
+//The canvas to viewport scale is precomputed as 16.16 fixed-point on every resize/zoom,
+//so a transform is one subtract, one multiply and one shift per coordinate.
+class Viewport{
+public:
+    static constexpr int        fixed_shift = 16;
+    static constexpr int32_t    fixed_one = 1 << fixed_shift;
+
+    Viewport(
+        const int32_t _canvas_width = 0, const int32_t _canvas_height = 0,
+        const int32_t _width = 0, const int32_t _height = 0
+    );
+
+    void canvas(const int32_t _canvas_width, const int32_t _canvas_height);
+    void resize(const int32_t _width, const int32_t _height);
+
+    //_zoom is given in fixed_one units - fixed_one fits the whole canvas in the viewport
+    void zoom(const int32_t _zoom);
+    //the canvas point shown in the viewport center
+    void center(const int32_t _x, const int32_t _y);
+    //move the viewport by a delta given in viewport units
+    void pan(const int32_t _dx, const int32_t _dy);
+
+    int32_t canvasWidth()const{
+        return canvas_width;
+    }
+    int32_t canvasHeight()const{
+        return canvas_height;
+    }
+    int32_t width()const{
+        return view_width;
+    }
+    int32_t height()const{
+        return view_height;
+    }
+    int32_t zoom()const{
+        return zoom_factor;
+    }
+    int32_t centerX()const{
+        return center_x;
+    }
+    int32_t centerY()const{
+        return center_y;
+    }
+
+    int32_t x(const int32_t _x)const{
+        return static_cast<int32_t>((static_cast<int64_t>(_x - center_x) * scale_x) >> fixed_shift);
+    }
+
+    int32_t y(const int32_t _y)const{
+        return static_cast<int32_t>((static_cast<int64_t>(_y - center_y) * scale_y) >> fixed_shift);
+    }
+
+    int32_t reverseX(const int32_t _x)const{
+        return scale_x ? static_cast<int32_t>((static_cast<int64_t>(_x) << fixed_shift) / scale_x) + center_x : center_x;
+    }
+
+    int32_t reverseY(const int32_t _y)const{
+        return scale_y ? static_cast<int32_t>((static_cast<int64_t>(_y) << fixed_shift) / scale_y) + center_y : center_y;
+    }
+
+    //the canvas rectangle shown by the viewport, grown by _margin viewport units on every side
+    void canvasBounds(
+        const int32_t _margin,
+        int32_t &_rleft, int32_t &_rtop, int32_t &_rright, int32_t &_rbottom
+    )const;
+
+    //in place transform of canvas coordinates
+    void transform(PlotEntry *_pentries, const size_t _count)const;
+private:
+    void update();
+private:
+    int32_t     canvas_width;
+    int32_t     canvas_height;
+    int32_t     view_width;
+    int32_t     view_height;
+    int32_t     zoom_factor;
+    int32_t     center_x;
+    int32_t     center_y;
+    int64_t     scale_x;//fixed-point, viewport units per canvas unit
+    int64_t     scale_y;
+};
+
+}//namespace client
+}//namespace bubbles
+
+#endif
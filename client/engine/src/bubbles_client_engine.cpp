@@ -4,16 +4,22 @@
 
 #include "solid/frame/timer.hpp"
 #include "solid/frame/reactorcontext.hpp"
-#include "solid/system/log.hpp"
+#include "protocol/bubbles_log.hpp"
 #include "solid/system/cassert.hpp"
 #include "solid/utility/any.hpp"
 #include "solid/utility/event.hpp"
 
 #include <queue>
 #include <deque>
+#include <stack>
+#include <unordered_map>
+#include <unordered_set>
 #include <mutex>
 #include <condition_variable>
 #include <random>
+#include <chrono>
+#include <algorithm>
+#include <memory>
 
 
 
@@ -23,11 +29,29 @@ using namespace std;
 namespace bubbles{
 namespace client{
 
+//the per event logs keep one line in log_sample_count - see bubbles_log_sampled
+const size_t log_sample_count = 1024;
+
 using EventQueueT = queue<Event>;
 
-using EventsNotificationDequeT = deque<std::shared_ptr<EventsNotification>>;
+using EventsNotificationPointerT = std::shared_ptr<EventsNotification>;//shared_ptr beacause mpipc sendMessage uses shared_ptr
+using EventsNotificationDequeT = deque<EventsNotificationPointerT>;
 
 struct PlotStub{
+    PlotStub():rgb_color(0), x(0), y(0), pending_pos(0), ploted(false){}
+
+    //a slot with no color is free - valid colors given by server are never 0
+    bool empty()const{
+        return rgb_color == 0;
+    }
+
+    void clear(){
+        rgb_color = 0;
+        text.clear();
+        pending_pos = 0;
+        ploted = false;
+    }
+
     uint32_t    rgb_color;
     int32_t     x;
     int32_t     y;
@@ -36,8 +60,121 @@ struct PlotStub{
     bool        ploted;
 };
 
-using PlotStubDequeT = deque<PlotStub>;
-using EventStubDequeT = deque<EventStub>;
+//slot-indexed peer table: a peer keeps its slot for as long as it is in the room
+//so the iteration (i.e. rendering) order is stable and insert/erase are O(1)
+using PlotStubVectorT = vector<PlotStub>;
+using PlotIndexMapT = unordered_map<uint32_t, size_t>;
+using IndexStackT = stack<size_t>;
+using SteadyTimePointT = std::chrono::steady_clock::time_point;
+
+//uniform grid over a plotvec - cell_start[c]..cell_start[c + 1] delimits
+//the plotvec slots of cell c within cell_slot (counting sort layout)
+//it is rebuilt on the engine's thread together with the plotvec it indexes
+//so a zoomed in viewport only visits the peers in the cells it overlaps
+struct PlotGrid{
+    using IndexVectorT = vector<uint32_t>;
+
+    static const int cell_size = 256;//canvas units
+
+    PlotGrid():columns(0), rows(0), left(0), top(0){}
+
+    void init(const int _canvas_width, const int _canvas_height){
+        columns = (_canvas_width + cell_size - 1) / cell_size;
+        rows = (_canvas_height + cell_size - 1) / cell_size;
+        left = -_canvas_width/2;
+        top = -_canvas_height/2;
+        cell_start.assign(columns * rows + 1, 0);
+    }
+
+    int column(const int32_t _x)const{
+        return std::min(std::max((_x - left) / cell_size, 0), columns - 1);
+    }
+
+    int row(const int32_t _y)const{
+        return std::min(std::max((_y - top) / cell_size, 0), rows - 1);
+    }
+
+    size_t cell(const int32_t _x, const int32_t _y)const{
+        return row(_y) * columns + column(_x);
+    }
+
+    void build(const PlotStubVectorT &_rplotvec){
+        std::fill(cell_start.begin(), cell_start.end(), 0);
+
+        for(const auto &rplot_stub: _rplotvec){
+            if(!rplot_stub.empty()){
+                ++cell_start[cell(rplot_stub.x, rplot_stub.y) + 1];
+            }
+        }
+        for(size_t i = 1; i < cell_start.size(); ++i){
+            cell_start[i] += cell_start[i - 1];
+        }
+
+        cell_slot.resize(cell_start.back());
+        cell_fill.assign(cell_start.begin(), cell_start.end() - 1);
+
+        for(size_t i = 0; i < _rplotvec.size(); ++i){
+            const PlotStub &rplot_stub = _rplotvec[i];
+            if(!rplot_stub.empty()){
+                cell_slot[cell_fill[cell(rplot_stub.x, rplot_stub.y)]++] = i;
+            }
+        }
+    }
+
+    int             columns;
+    int             rows;
+    int32_t         left;
+    int32_t         top;
+    IndexVectorT    cell_start;
+    IndexVectorT    cell_slot;
+    IndexVectorT    cell_fill;
+};
+
+struct PendingEventStub{
+    PendingEventStub(
+        EventStub &&_uevent_stub, const SteadyTimePointT &_rrecv_time
+    ):event_stub(std::move(_uevent_stub)), recv_time(_rrecv_time){}
+
+    EventStub           event_stub;
+    SteadyTimePointT    recv_time;
+};
+
+using PendingEventStubDequeT = deque<PendingEventStub>;
+
+struct SendStub{
+    SendStub(
+        const EventsNotification *_pmsg, const SteadyTimePointT &_rtime
+    ):pmsg(_pmsg), time(_rtime){}
+
+    const EventsNotification    *pmsg;
+    SteadyTimePointT            time;
+};
+
+using SendStubVectorT = vector<SendStub>;
+
+struct SentStub{
+    SentStub(
+        EventsNotificationPointerT &&_umsg_ptr, const SteadyTimePointT &_rtime, const bool _round_trip
+    ):msg_ptr(std::move(_umsg_ptr)), time(_rtime), round_trip(_round_trip){}
+
+    EventsNotificationPointerT  msg_ptr;
+    SteadyTimePointT            time;
+    bool                        round_trip;//given back on the server's acknowledgement
+};
+
+using SentStubDequeT = deque<SentStub>;
+
+struct ReceivedStub{
+    ReceivedStub(
+        EventsNotificationPointerT &&_umsg_ptr, const SteadyTimePointT &_rtime
+    ):msg_ptr(std::move(_umsg_ptr)), time(_rtime){}
+
+    EventsNotificationPointerT  msg_ptr;
+    SteadyTimePointT            time;//when it arrived in eventsReceived
+};
+
+using ReceivedStubDequeT = deque<ReceivedStub>;
+using ColorSetT = unordered_set<uint32_t>;
 
 using AutoPairT = std::pair<int, int>;
 using AutoAtomicPairT = std::pair<atomic<int>, atomic<int>>;
@@ -61,23 +198,70 @@ const EventCategory<Events> event_category{
 
 
 
+//the default transport - the mpipc service given to Engine::create
+class MpipcTransport: public Transport{
+public:
+    MpipcTransport(
+        frame::mpipc::Service &_rmpipc,
+        const string &_rserver_endpoint
+    ):rmpipc(_rmpipc), rserver_endpoint(_rserver_endpoint){}
+
+    solid::ErrorConditionT sendEvents(
+        Engine &/*_rengine*/,
+        EventsNotificationPointerT const &_rmsg_ptr
+    ) override{
+        if(dynamic_cast<const EventsNotificationRequest*>(_rmsg_ptr.get())){
+            //completes (see Engine::onMessage) on the server's EventsNotificationResponse
+            return rmpipc.sendMessage(
+                rserver_endpoint.c_str(), _rmsg_ptr,
+                {frame::mpipc::MessageFlagsE::Synchronous, frame::mpipc::MessageFlagsE::WaitResponse}
+            );
+        }
+        return rmpipc.sendMessage(rserver_endpoint.c_str(), _rmsg_ptr, {frame::mpipc::MessageFlagsE::Synchronous});
+    }
+
+    solid::ErrorConditionT sendSuspend(
+        Engine &/*_rengine*/,
+        std::shared_ptr<SuspendNotification> const &_rmsg_ptr
+    ) override{
+        return rmpipc.sendMessage(recipient_id, _rmsg_ptr, {frame::mpipc::MessageFlagsE::Synchronous});
+    }
+
+    void closeConnection(Engine &/*_rengine*/) override{
+        auto lambda = [](solid::frame::mpipc::ConnectionContext &_rctx){};
+        rmpipc.forceCloseConnectionPool(recipient_id, lambda);
+    }
+
+    frame::mpipc::RecipientId   recipient_id;//of the last started connection
+private:
+    frame::mpipc::Service       &rmpipc;
+    const string                &rserver_endpoint;
+};
+
+using MpipcTransportPointerT = std::unique_ptr<MpipcTransport>;
+
 struct Engine::Data{
     static const int canvas_width = 7680;
     static const int canvas_height = 7680;//use the 8K width
     
     Data(
+        Engine &_rengine,
         solid::frame::ServiceT &_rsvc,
-        solid::frame::mpipc::Service &_rmpipc,
         const EngineConfiguration &_cfg,
         const frame::ObjectProxy &_proxy
-    ):  rmpipc(_rmpipc), service(_rsvc), cfg(_cfg), push_eventq_idx(0), pop_eventq_idx(1),
-        push_messagedq_idx(0), pop_messagedq_idx(1), read_plotdq_idx(0), write_plotdq_idx(1), read_plotdq_count(0),
-        discarded_on_push(false), rgb_color(0), auto_pilot(false), timer(_proxy), auto_timer(_proxy),
+    ):  rengine(_rengine), ptransport(nullptr), service(_rsvc), cfg(_cfg), push_eventq_idx(0), pop_eventq_idx(1),
+        push_messagedq_idx(0), pop_messagedq_idx(1), read_plotvec_idx(0), write_plotvec_idx(1), read_plotvec_count(0),
+        discarded_on_push(false), dropped_event_count(0), move_kept(false), move_x(0), move_y(0),
+        move_dropped(false), move_dropped_x(0), move_dropped_y(0), move_flush_requested(false), move_timer_armed(false),
+        rgb_color(0), auto_pilot(false), catching_up(false),
+        send_rtt(0), send_timer_armed(false), timer(_proxy), auto_timer(_proxy), send_timer(_proxy), move_timer(_proxy),
         auto_crt_w(canvas_width/2), auto_crt_h(canvas_height/2), auto_mod_w(0), auto_mod_h(0), auto_frame_changed(false), auto_plot_done(true),
         auto_plot_idx(0), auto_fill_idx(1),
         auto_dist_x(-auto_crt_w, auto_crt_w), auto_dist_y(-auto_crt_h, auto_crt_h),
-        auto_dist_steps(1, 100), paused(false)
+        auto_dist_steps(1, 100), paused(false), registered(false), suspended(false)
     {
+        plotgrid[0].init(canvas_width, canvas_height);
+        plotgrid[1].init(canvas_width, canvas_height);
         auto_plot[0].first = 0;
         auto_plot[0].second = 0;
         auto_plot[1].first = 0;
@@ -86,10 +270,237 @@ struct Engine::Data{
 
     void discardPopEventQ(){
         EventQueueT &eq = eventq[pop_eventq_idx];
+        dropped_event_count += eq.size();
         while(eq.size()) eq.pop();
     }
 
-    frame::mpipc::Service                   &rmpipc;
+    //source side decimation - must be called under mtx
+    bool dropMoveEvent(const int _x, const int _y, const SteadyTimePointT &_rnow)const{
+        if(!move_kept){
+            return false;
+        }
+        if(cfg.move_min_distance){
+            const int64_t dx = _x - move_x;
+            const int64_t dy = _y - move_y;
+            const int64_t min_distance = cfg.move_min_distance;
+
+            if((dx * dx + dy * dy) < (min_distance * min_distance)){
+                return true;
+            }
+        }
+        if(cfg.move_min_interval_msec){
+            if((_rnow - move_time) < std::chrono::milliseconds(cfg.move_min_interval_msec)){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //a decimated sample is sent anyway once the last kept one is this old - so a pointer
+    //stopping mid drag is not left behind on the peers
+    std::chrono::milliseconds moveFlushDelay()const{
+        return std::chrono::milliseconds(cfg.move_min_interval_msec ? cfg.move_min_interval_msec : 16);
+    }
+
+    //keep a moveEvent sample - must be called under mtx
+    //returns true when the engine must be notified (the queue was empty)
+    bool pushMoveEvent(const int _x, const int _y, const SteadyTimePointT &_rnow){
+        move_kept = true;
+        move_x = _x;
+        move_y = _y;
+        move_time = _rnow;
+        move_dropped = false;
+
+        EventQueueT &reventq = eventq[push_eventq_idx];
+
+        if((reventq.size() + 1) == cfg.max_event_queue_size){
+            reventq.pop();
+            discarded_on_push = true;
+            ++dropped_event_count;
+        }
+        reventq.push(Event());
+        reventq.back().type = Event::PointerMove;
+        reventq.back().x = _x;
+        reventq.back().y = _y;
+        if(cfg.probe){
+            reventq.back().flags |= Event::ProbeFlag;
+            reventq.back().data = std::chrono::duration_cast<std::chrono::microseconds>(_rnow.time_since_epoch()).count();
+        }
+        return reventq.size() == 1;
+    }
+
+    //take back the messages the transport is done with and update the smoothed round trip time
+    void reclaimSentMessages(){
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            swap(sent_stubdq, reclaim_stubdq);
+        }
+        for(auto &rsent_stub: reclaim_stubdq){
+            auto it = std::find_if(
+                send_stubvec.begin(), send_stubvec.end(),
+                [&rsent_stub](const SendStub &_rss){return _rss.pmsg == rsent_stub.msg_ptr.get();}
+            );
+            if(it != send_stubvec.end()){
+                if(rsent_stub.round_trip){
+                    const std::chrono::microseconds sample = std::chrono::duration_cast<std::chrono::microseconds>(rsent_stub.time - it->time);
+
+                    //rfc6298 like smoothing
+                    send_rtt = send_rtt.count() ? (send_rtt * 7 + sample) / 8 : sample;
+                }
+                *it = send_stubvec.back();
+                send_stubvec.pop_back();
+            }
+            free_messagedq.push_back(std::move(rsent_stub.msg_ptr));
+        }
+        reclaim_stubdq.clear();
+    }
+
+    //pacing: while the event queue is shallow, spread the messages of a window over the round trip time
+    //and wait at least send_batch_interval_msec between sends so more events go in a message;
+    //a deep queue is sent right away, before moveEvent starts dropping events
+    SteadyTimePointT nextSendTime(const size_t _queue_depth)const{
+        if((_queue_depth * 2) >= cfg.max_event_queue_size){
+            return last_send_time;
+        }
+        std::chrono::microseconds interval = std::chrono::milliseconds(cfg.send_batch_interval_msec);
+
+        if(cfg.send_window_size){
+            interval = std::max(interval, send_rtt / static_cast<int>(cfg.send_window_size));
+        }
+        return last_send_time + interval;
+    }
+
+    //the sender stamped probe events with its steady clock - only meaningful when both ends share the clock
+    void recordLatency(const EventStub &_revent_stub, const uint64_t _now_usec){
+        if(_revent_stub.event.flags & Event::ProbeFlag and _revent_stub.event.data <= _now_usec){
+            latency_histogram.record(_now_usec - _revent_stub.event.data);
+        }
+        for(const auto &revent: _revent_stub.events){
+            if(revent.flags & Event::ProbeFlag and revent.data <= _now_usec){
+                latency_histogram.record(_now_usec - revent.data);
+            }
+        }
+    }
+
+    bool sendLastEvent(){
+        if(free_messagedq.empty()){
+            return false;
+        }
+        EventsNotificationPointerT msg_ptr{std::move(free_messagedq.front())};
+        free_messagedq.pop_front();
+
+        msg_ptr->event_stub.event = last_event;
+        msg_ptr->event_stub.event.flags &= ~Event::ProbeFlag;//a repeated event says nothing about latency
+        return doSendMessage(std::move(msg_ptr));
+    }
+
+    bool doSendMessage(EventsNotificationPointerT &&_umsg_ptr){
+        const SteadyTimePointT  now = std::chrono::steady_clock::now();
+        const auto              *pmsg = _umsg_ptr.get();
+
+        solid::ErrorConditionT  err = ptransport->sendEvents(rengine, _umsg_ptr);
+        if(err){
+            const size_t event_count = _umsg_ptr->event_stub.events.size() + 1;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                dropped_event_count += event_count;
+            }
+            bubbles_log(generic_logger, Error, ""<< " sendMessage error: "<<err.message()<<" - dropped "<<event_count<<" events");
+            //the transport did not take the message - give back its window slot
+            _umsg_ptr->clear();
+            free_messagedq.push_back(std::move(_umsg_ptr));
+            return false;
+        }
+        send_stubvec.emplace_back(pmsg, now);
+        last_send_time = now;
+        return true;
+    }
+
+    //plot table functions must only be called on the engine's thread
+    size_t plotInsert(const uint32_t _rgb_color){
+        PlotStubVectorT &rplotvec = plotvec[write_plotvec_idx];
+        size_t          index;
+
+        if(plot_free_stack.size()){
+            index = plot_free_stack.top();
+            plot_free_stack.pop();
+        }else{
+            index = rplotvec.size();
+            rplotvec.push_back(PlotStub{});
+        }
+        rplotvec[index].rgb_color = _rgb_color;
+        plot_index_map[_rgb_color] = index;
+        return index;
+    }
+
+    void plotErase(PlotIndexMapT::iterator _it){
+        plotvec[write_plotvec_idx][_it->second].clear();
+        plot_free_stack.push(_it->second);
+        plot_index_map.erase(_it);
+    }
+
+    //see if the backlog of event stubs lags too much behind real time
+    CatchUpE catchUp(const SteadyTimePointT &_rnow){
+        if(cfg.catch_up == CatchUpE::None or event_stubdq.empty()){
+            catching_up = false;
+            return CatchUpE::None;
+        }
+        SteadyTimePointT    oldest_time = _rnow;
+        size_t              backlog = 0;
+
+        for(const auto& rpending: event_stubdq){
+            backlog += rpending.event_stub.events.size() + 1;
+            oldest_time = std::min(oldest_time, rpending.recv_time);
+        }
+
+        const size_t lag_msec = std::chrono::duration_cast<std::chrono::milliseconds>(_rnow - oldest_time).count();
+
+        if(lag_msec > cfg.catch_up_max_lag_msec or backlog > cfg.catch_up_max_backlog){
+            if(!catching_up){
+                catching_up = true;
+                bubbles_log(generic_logger, Warning, "catching up: lag = "<<lag_msec<<"msec backlog = "<<backlog<<" events");
+            }
+            return cfg.catch_up;
+        }
+        catching_up = false;
+        return CatchUpE::None;
+    }
+
+    //keep only the newest event stub of every peer, reduced to its latest sample
+    void collapseEventStubs(){
+        auto &rplotvec = plotvec[write_plotvec_idx];
+
+        collapse_color_set.clear();
+        collapse_event_stubdq.clear();
+
+        for(auto it = event_stubdq.rbegin(); it != event_stubdq.rend(); ++it){
+            EventStub &revent_stub = it->event_stub;
+
+            if(collapse_color_set.insert(revent_stub.sender_rgb_color).second){
+                if(revent_stub.events.size()){
+                    revent_stub.event = revent_stub.events.back();
+                    revent_stub.events.clear();
+                }
+                auto plot_it = plot_index_map.find(revent_stub.sender_rgb_color);
+                if(plot_it != plot_index_map.end()){
+                    rplotvec[plot_it->second].pending_pos = 0;
+                }
+                collapse_event_stubdq.push_front(std::move(*it));
+            }
+        }
+        swap(event_stubdq, collapse_event_stubdq);
+        collapse_event_stubdq.clear();
+    }
+
+    void plotClear(){
+        plotvec[write_plotvec_idx].clear();
+        plot_index_map.clear();
+        while(plot_free_stack.size()) plot_free_stack.pop();
+    }
+
+    Engine                                  &rengine;
+    MpipcTransportPointerT                  mpipc_transport_ptr;//when created with an mpipc service
+    Transport                               *ptransport;
 
     frame::ServiceT                         &service;
     string                                  server_endpoint;
@@ -103,29 +514,54 @@ struct Engine::Data{
     size_t                                  push_messagedq_idx;
     size_t                                  pop_messagedq_idx;
 
-    size_t                                  read_plotdq_idx;
-    size_t                                  write_plotdq_idx;
-    size_t                                  read_plotdq_count;
+    size_t                                  read_plotvec_idx;
+    size_t                                  write_plotvec_idx;
+    size_t                                  read_plotvec_count;
 
     bool                                    discarded_on_push;
+    size_t                                  dropped_event_count;
+    EngineStatistics                        statistics;//guarded by mtx - dropped_event_count is kept separately
+    LatencyHistogram                        latency_histogram;//guarded by mtx
+    bool                                    move_kept;//last kept moveEvent sample:
+    int                                     move_x;
+    int                                     move_y;
+    SteadyTimePointT                        move_time;
+    bool                                    move_dropped;//last dropped moveEvent sample, newer than the kept one:
+    int                                     move_dropped_x;
+    int                                     move_dropped_y;
+    bool                                    move_flush_requested;//the engine was asked to arm move_timer - guarded by mtx
+    bool                                    move_timer_armed;//engine's thread only
     uint32_t                                rgb_color;
     bool                                    auto_pilot;
+    bool                                    catching_up;//for logging only the transition into catch up
     Event                                   last_event;
-    std::shared_ptr<EventsNotification>     events_message_ptr;//shared_ptr beacause mpipc sendMessage uses shared_ptr
-    std::shared_ptr<EventsNotification>     tmp_events_message_ptr;
+    EventsNotificationDequeT                free_messagedq;//messages ready to be filled - at most send_window_size
+    SendStubVectorT                         send_stubvec;//messages in flight
+    SentStubDequeT                          sent_stubdq;//messages given back by mpipc - guarded by mtx
+    SentStubDequeT                          reclaim_stubdq;
+    std::chrono::microseconds               send_rtt;//smoothed round trip time of the acknowledged messages - see onEvent(Start)
+    SteadyTimePointT                        last_send_time;
+    bool                                    send_timer_armed;
 
     //all functions must be called on the engine's thread
     ExitFunctionT                           exit_function;
     GuiUpdateFunctionT                      gui_update_function;
     AutoUpdateFunctionT                     auto_update_function;
 
-    EventsNotificationDequeT                messagedq[2];
-    PlotStubDequeT                          plotdq[2];
-    EventStubDequeT                         event_stubdq;
+    ReceivedStubDequeT                      messagedq[2];
+    PlotStubVectorT                         plotvec[2];
+    PlotGrid                                plotgrid[2];//spatial index of the plotvec with the same index
+    PlotIndexMapT                           plot_index_map;//rgb_color -> slot in plotvec - same for both plotvecs
+    IndexStackT                             plot_free_stack;
+    PendingEventStubDequeT                  event_stubdq;
+    PendingEventStubDequeT                  collapse_event_stubdq;
+    ColorSetT                               collapse_color_set;
     mutex                                   mtx;
     condition_variable                      cnd;
     frame::SteadyTimer                      timer;
     frame::SteadyTimer                      auto_timer;
+    frame::SteadyTimer                      send_timer;
+    frame::SteadyTimer                      move_timer;//flushes the last dropped moveEvent sample
 
     int                                     auto_crt_w;
     int                                     auto_crt_h;
@@ -143,13 +579,14 @@ struct Engine::Data{
     std::uniform_int_distribution<int>      auto_dist_steps;
     AutoQueueT                              auto_q;
     AtomicBoolT                             paused;
-    frame::mpipc::RecipientId               mpipc_recipient;
+    AtomicBoolT                             registered;//there is a registered connection to the server
+    bool                                    suspended;//the server was asked to stop streaming updates
 };
 
 
 //=============================================================================
 PlotIterator::PlotIterator(PlotIterator &&_plotit):peng(_plotit.peng){
-    plotdq_index = _plotit.plotdq_index;
+    plotvec_index = _plotit.plotvec_index;
     pos = _plotit.pos;
     _plotit.peng = nullptr;
     rgb_color = _plotit.rgb_color;
@@ -164,8 +601,8 @@ PlotIterator::~PlotIterator(){
 void PlotIterator::clear(){
     if(peng){
         std::unique_lock<std::mutex>    lock(peng->d.mtx);
-        --peng->d.read_plotdq_count;
-        if(peng->d.read_plotdq_count == 0){
+        --peng->d.read_plotvec_count;
+        if(peng->d.read_plotvec_count == 0){
             peng->d.cnd.notify_one();
         }
         peng = nullptr;
@@ -174,49 +611,70 @@ void PlotIterator::clear(){
 
 PlotIterator& PlotIterator::operator=(PlotIterator &&_plotit){
     peng = _plotit.peng;
-    plotdq_index = _plotit.plotdq_index;
+    plotvec_index = _plotit.plotvec_index;
     pos = _plotit.pos;
     _plotit.peng = nullptr;
     rgb_color = _plotit.rgb_color;
     return *this;
 }
 uint32_t PlotIterator::rgbColor()const{
-    return peng->d.plotdq[plotdq_index][pos].rgb_color;
+    return peng->d.plotvec[plotvec_index][pos].rgb_color;
 }
 
 int32_t PlotIterator::x()const{
-    return peng->d.plotdq[plotdq_index][pos].x;
+    return peng->d.plotvec[plotvec_index][pos].x;
 }
 int32_t PlotIterator::y()const{
-    return peng->d.plotdq[plotdq_index][pos].y;
+    return peng->d.plotvec[plotvec_index][pos].y;
 }
 
 const std::string& PlotIterator::text()const{
-    return peng->d.plotdq[plotdq_index][pos].text;
+    return peng->d.plotvec[plotvec_index][pos].text;
 }
 
 bool PlotIterator::end()const{
-    return peng->d.plotdq[plotdq_index].size() == pos;
+    return peng->d.plotvec[plotvec_index].size() == pos;
 }
 
 PlotIterator& PlotIterator::operator++(){
     ++pos;
+    skipEmpty();
     return *this;
 }
 
+void PlotIterator::skipEmpty(){
+    const PlotStubVectorT &rplotvec = peng->d.plotvec[plotvec_index];
+    while(pos < rplotvec.size() and rplotvec[pos].empty()){
+        ++pos;
+    }
+}
+
 PlotIterator::PlotIterator(Engine &_reng):peng(&_reng){
     pos = 0;
-    std::unique_lock<std::mutex>    lock(peng->d.mtx);
-    plotdq_index = peng->d.read_plotdq_idx;
-    ++peng->d.read_plotdq_count;
-    rgb_color = peng->d.rgb_color;
+    {
+        std::unique_lock<std::mutex>    lock(peng->d.mtx);
+        plotvec_index = peng->d.read_plotvec_idx;
+        ++peng->d.read_plotvec_count;
+        rgb_color = peng->d.rgb_color;
+    }
+    skipEmpty();
 }
 
 //=============================================================================
 Engine::Engine(
     solid::frame::ServiceT &_rsvc, solid::frame::mpipc::Service &_rmpipc,
     const EngineConfiguration &_cfg
-):d(*(new Data(_rsvc, _rmpipc, _cfg, proxy()))){}
+):d(*(new Data(*this, _rsvc, _cfg, proxy()))){
+    d.mpipc_transport_ptr.reset(new MpipcTransport(_rmpipc, d.server_endpoint));
+    d.ptransport = d.mpipc_transport_ptr.get();
+}
+
+Engine::Engine(
+    solid::frame::ServiceT &_rsvc, Transport &_rtransport,
+    const EngineConfiguration &_cfg
+):d(*(new Data(*this, _rsvc, _cfg, proxy()))){
+    d.ptransport = &_rtransport;
+}
 
 Engine::~Engine(){
     delete &d;
@@ -229,7 +687,7 @@ solid::ErrorConditionT Engine::start(
     const bool _auto_pilot,
     uint32_t _rgb_color
 ){
-    solid_log(generic_logger, Info, "");
+    bubbles_log(generic_logger, Info, "");
     solid::ErrorConditionT                  err;
 
     if(!this->isRunning()){
@@ -284,38 +742,146 @@ PlotIterator Engine::plot(){
     return PlotIterator(*this);
 }
 
+Viewport Engine::viewport(const int _w, const int _h)const{
+    return Viewport(d.canvas_width, d.canvas_height, _w, _h);
+}
+
+size_t Engine::plotCopy(PlotEntry *_pentries, const size_t _capacity, const Viewport &_rviewport){
+    PlotIterator    plotit(*this);
+    size_t          count = 0;
+    int32_t         left, top, right, bottom;
+
+    _rviewport.canvasBounds(plot_margin, left, top, right, bottom);
+
+    const PlotStubVectorT   &rplotvec = d.plotvec[plotit.plotvec_index];
+    const PlotGrid          &rplotgrid = d.plotgrid[plotit.plotvec_index];
+    const int               first_column = rplotgrid.column(left);
+    const int               last_column = rplotgrid.column(right);
+    const int               last_row = rplotgrid.row(bottom);
+
+    //gather the canvas coordinates of the peers within the visible cells then transform them in one batch
+    for(int row = rplotgrid.row(top); row <= last_row; ++row){
+        const size_t first_cell = row * rplotgrid.columns + first_column;
+        const size_t last_cell = row * rplotgrid.columns + last_column;
+
+        for(uint32_t i = rplotgrid.cell_start[first_cell]; i < rplotgrid.cell_start[last_cell + 1]; ++i){
+            const PlotStub &rplot_stub = rplotvec[rplotgrid.cell_slot[i]];
+
+            if(
+                rplot_stub.x < left or rplot_stub.x > right or
+                rplot_stub.y < top or rplot_stub.y > bottom
+            ){
+                continue;
+            }
+            if(count < _capacity){
+                PlotEntry &rentry = _pentries[count];
+                rentry.x = rplot_stub.x;
+                rentry.y = rplot_stub.y;
+                rentry.rgb_color = rplot_stub.rgb_color;
+            }
+            ++count;
+        }
+    }
+    plotit.clear();
+    _rviewport.transform(_pentries, count < _capacity ? count : _capacity);
+    return count;
+}
+
+size_t Engine::plotCopy(PlotEntry *_pentries, const size_t _capacity, const long _w, const long _h){
+    return plotCopy(_pentries, _capacity, viewport(_w, _h));
+}
+
+uint32_t Engine::myRgbColor()const{
+    std::unique_lock<std::mutex>    lock(d.mtx);
+    return d.rgb_color;
+}
+
+void Engine::statistics(EngineStatistics &_rstatistics)const{
+    std::unique_lock<std::mutex>    lock(d.mtx);
+    _rstatistics = d.statistics;
+    _rstatistics.dropped_event_count = d.dropped_event_count;
+}
+
+void Engine::collectLatency(LatencyHistogram &_rhistogram){
+    std::unique_lock<std::mutex>    lock(d.mtx);
+    _rhistogram.merge(d.latency_histogram);
+    d.latency_histogram.clear();
+}
+
 bool Engine::autoPilot()const{
     return d.auto_pilot;
 }
 
-void Engine::moveEvent(int _x, int _y){
+void Engine::moveEvent(int _x, int _y, const bool _last){
 
-    solid_log(generic_logger, Info, _x<<':'<<_y);
-    bool notify_engine = false;
+    bubbles_log_sampled(generic_logger, Info, log_sample_count, _x<<':'<<_y<<' '<<_last);
+    const SteadyTimePointT  now = std::chrono::steady_clock::now();
+    bool                    notify_engine = false;
     {
         std::unique_lock<std::mutex>    lock(d.mtx);
-        EventQueueT                     &reventq = d.eventq[d.push_eventq_idx];
 
-        if((reventq.size() + 1) == d.cfg.max_event_queue_size){
-            reventq.pop();
-            d.discarded_on_push = true;
+        if(!_last and d.dropMoveEvent(_x, _y, now)){
+            //keep it for doFlushMoveEvent - in case no newer sample follows
+            d.move_dropped = true;
+            d.move_dropped_x = _x;
+            d.move_dropped_y = _y;
+            if(d.move_flush_requested){
+                return;
+            }
+            d.move_flush_requested = true;
+            notify_engine = true;
+        }else{
+            notify_engine = d.pushMoveEvent(_x, _y, now);
         }
-        reventq.push(Event());
-        reventq.back().type = Event::PointerMove;
-        reventq.back().x = _x;
-        reventq.back().y = _y;
-        notify_engine = (reventq.size() == 1);
     }
     if(notify_engine){
         d.service.manager().notify(d.service.manager().id(*this), generic_event_category.event(GenericEvents::Raise));
     }
 }
 
+//send the last dropped moveEvent sample once the last kept one is moveFlushDelay old
+void Engine::doFlushMoveEvent(solid::frame::ReactorContext &_rctx){
+    const SteadyTimePointT  now = std::chrono::steady_clock::now();
+    SteadyTimePointT        flush_time;
+    {
+        std::unique_lock<std::mutex>    lock(d.mtx);
+
+        if(!d.move_flush_requested or d.move_timer_armed){
+            return;
+        }
+        if(!d.move_dropped){
+            //a newer sample was kept
+            d.move_flush_requested = false;
+            return;
+        }
+        flush_time = d.move_time + d.moveFlushDelay();
+        if(flush_time <= now){
+            d.move_flush_requested = false;
+            d.pushMoveEvent(d.move_dropped_x, d.move_dropped_y, now);
+        }
+    }
+    if(flush_time > now){
+        d.move_timer_armed = true;
+        d.move_timer.waitUntil(
+            _rctx, _rctx.steadyTime() + std::chrono::duration_cast<std::chrono::microseconds>(flush_time - now),
+            [this](solid::frame::ReactorContext &_rctx){
+                d.move_timer_armed = false;
+                doFlushMoveEvent(_rctx);
+                doTrySendEvents(_rctx);
+            }
+        );
+    }
+}
+
 void Engine::onEvent(frame::ReactorContext &_rctx, solid::Event &&_uevent) /*override*/{
-    solid_log(generic_logger, Info, " event = "<<_uevent);
+    bubbles_log(generic_logger, Info, " event = "<<_uevent);
     if(generic_event_category.event(GenericEvents::Start) == _uevent){
 
-        d.events_message_ptr = std::make_shared<EventsNotification>();
+        //one message of the window asks for an acknowledgement - the round trip the pacing uses
+        d.free_messagedq.push_back(std::make_shared<EventsNotificationRequest>());
+        for(size_t i = 1; i < d.cfg.send_window_size; ++i){
+            d.free_messagedq.push_back(std::make_shared<EventsNotification>());
+        }
         if(d.auto_pilot){
             onAutoPilot(_rctx);
         }
@@ -323,7 +889,7 @@ void Engine::onEvent(frame::ReactorContext &_rctx, solid::Event &&_uevent) /*ove
         d.paused = true;
         postStop(_rctx);
     }else if(generic_event_category.event(GenericEvents::Raise) == _uevent){
-        doTrySendEvents();
+        doTrySendEvents(_rctx);
     }else if(generic_event_category.event(GenericEvents::Message) == _uevent){
         doProcessIncomingNotifications(_rctx);
     }else if(generic_event_category.event(GenericEvents::Stop) == _uevent){
@@ -342,21 +908,39 @@ void Engine::onEvent(frame::ReactorContext &_rctx, solid::Event &&_uevent) /*ove
 }
 
 void Engine::doPause(solid::frame::ReactorContext &_rctx){
-    auto lambda = [](solid::frame::mpipc::ConnectionContext &_rctx){};
-    d.rmpipc.forceCloseConnectionPool(d.mpipc_recipient, lambda);
+    if(d.cfg.suspend_on_pause && d.registered){
+        //keep the connection (kept alive by mpipc keepalive) and only stop the updates
+        auto                    msg_ptr = std::make_shared<SuspendNotification>(true);
+        solid::ErrorConditionT  err = d.ptransport->sendSuspend(*this, msg_ptr);
+
+        if(!err){
+            d.suspended = true;
+            return;
+        }
+        bubbles_log(generic_logger, Error, "failed sending suspend: "<<err.message());
+    }
+    d.ptransport->closeConnection(*this);
 }
 
 void Engine::doResume(solid::frame::ReactorContext &_rctx){
     d.paused = false;
-    if(d.events_message_ptr){
-        d.events_message_ptr->event_stub.event = d.last_event;
-        std::shared_ptr<EventsNotification> tmp_ptr{std::move(d.events_message_ptr)};
-        d.rmpipc.sendMessage(d.server_endpoint.c_str(), tmp_ptr);
+    if(d.suspended){
+        d.suspended = false;
+        if(d.registered){
+            //the server will push the current state of the room
+            auto                    msg_ptr = std::make_shared<SuspendNotification>(false);
+            solid::ErrorConditionT  err = d.ptransport->sendSuspend(*this, msg_ptr);
+            if(err){
+                bubbles_log(generic_logger, Error, "failed sending resume: "<<err.message());
+            }
+        }//else the connection was lost while suspended - sending the last event will reconnect
+    }
+    d.reclaimSentMessages();
+    if(d.send_stubvec.empty()){
+        d.sendLastEvent();
     }
     //clear all events
-    auto& rplotdq = d.plotdq[d.write_plotdq_idx];
-
-    rplotdq.clear();
+    d.plotClear();
     d.event_stubdq.clear();
 
     if(autoPilot()){
@@ -365,21 +949,14 @@ void Engine::doResume(solid::frame::ReactorContext &_rctx){
 }
 
 void Engine::doHandleConnectionStop(solid::frame::ReactorContext &_rctx){
-    if(d.events_message_ptr && !d.paused){
-        solid_log(generic_logger, Info, "");
+    d.reclaimSentMessages();
+    if(d.send_stubvec.empty() && !d.paused){
+        bubbles_log(generic_logger, Info, "");
         //connection stopped and there is no activity to send, resend the last event
-        d.events_message_ptr->event_stub.event = d.last_event;
-
-        std::shared_ptr<EventsNotification> tmp_ptr{std::move(d.events_message_ptr)};
-        solid::ErrorConditionT  err = d.rmpipc.sendMessage(d.server_endpoint.c_str(), tmp_ptr);
-        if(err){
-            solid_log(generic_logger, Error, ""<< " sendMessage error: "<<err.message());
-        }
+        d.sendLastEvent();
         
         //clear all events
-        auto& rplotdq = d.plotdq[d.write_plotdq_idx];
-
-        rplotdq.clear();
+        d.plotClear();
         d.event_stubdq.clear();
     }
 }
@@ -468,107 +1045,111 @@ void Engine::onAutoPilot(solid::frame::ReactorContext &_rctx){
 }
 
 void Engine::doProcessIncomingNotifications(solid::frame::ReactorContext &_rctx){
-    solid_log(generic_logger, Info, "");
+    bubbles_log_sampled(generic_logger, Info, log_sample_count, "");
     {
         std::unique_lock<std::mutex> lock(d.mtx);
         swap(d.pop_messagedq_idx, d.push_messagedq_idx);
     }
 
-    EventsNotificationDequeT    &rmessagedq{d.messagedq[d.pop_messagedq_idx]};
+    ReceivedStubDequeT          &rmessagedq{d.messagedq[d.pop_messagedq_idx]};
+
+    const SteadyTimePointT      now = std::chrono::steady_clock::now();
+
+    //put all the event stubs in a queue - stamped with the time their message arrived
+    for(auto& rrecv_stub:rmessagedq){
+        auto &msg_ptr = rrecv_stub.msg_ptr;
 
-    //put all the event stubs in a queue
-    for(auto& msg_ptr:rmessagedq){
-        solid_log(generic_logger, Info, " event_stub with color ("<<msg_ptr->event_stub.sender_rgb_color<<") main event "<<msg_ptr->event_stub.event.x<<":"<<msg_ptr->event_stub.event.y<<" and other "<<msg_ptr->event_stub.events.size()<<" events");
-        d.event_stubdq.push_back(std::move(msg_ptr->event_stub));
+        bubbles_log_sampled(generic_logger, Info, log_sample_count, " event_stub with color ("<<msg_ptr->event_stub.sender_rgb_color<<") main event "<<msg_ptr->event_stub.event.x<<":"<<msg_ptr->event_stub.event.y<<" and other "<<msg_ptr->event_stub.events.size()<<" events");
+        d.event_stubdq.emplace_back(std::move(msg_ptr->event_stub), rrecv_stub.time);
         for(auto &e_s: msg_ptr->event_stubs){
-            solid_log(generic_logger, Info, " event_stub with color ("<<e_s.sender_rgb_color<<") main event "<<e_s.event.x<<":"<<e_s.event.y<<" and other "<<e_s.events.size()<<" events");
-            d.event_stubdq.push_back(std::move(e_s));
+            bubbles_log_sampled(generic_logger, Info, log_sample_count, " event_stub with color ("<<e_s.sender_rgb_color<<") main event "<<e_s.event.x<<":"<<e_s.event.y<<" and other "<<e_s.events.size()<<" events");
+            d.event_stubdq.emplace_back(std::move(e_s), rrecv_stub.time);
         }
     }
 
     rmessagedq.clear();
 
-    auto& rplotdq = d.plotdq[d.write_plotdq_idx];
+    const CatchUpE  catch_up = d.catchUp(now);
+    //how many samples a peer advances on this pass
+    const size_t    step = catch_up == CatchUpE::Accelerate ? std::max(d.cfg.catch_up_step, static_cast<size_t>(1)) : 1;
+
+    if(catch_up == CatchUpE::Collapse){
+        d.collapseEventStubs();
+    }
+
+    auto& rplotvec = d.plotvec[d.write_plotvec_idx];
 
     const size_t qsz = d.event_stubdq.size();
     for(size_t i = 0; i < qsz; ++i){
-        auto&       revent_stub = d.event_stubdq.front();
+        auto&       rpending = d.event_stubdq.front();
+        auto&       revent_stub = rpending.event_stub;
 
         bool        drop_event_stub = false;
+        PlotStub    *pps = nullptr;
 
-        auto bin_srch_ret = solid::binary_search(
-            rplotdq.begin(), rplotdq.end(), revent_stub.sender_rgb_color,
-            [](const PlotStub &_rps, const uint32_t _key){
-                if(_key < _rps.rgb_color) return -1;
-                if(_key > _rps.rgb_color) return 1;
-                return 0;
+        auto        plot_it = d.plot_index_map.find(revent_stub.sender_rgb_color);
+
+        if(plot_it != d.plot_index_map.end()){//entry found
+            if(rplotvec[plot_it->second].ploted){
+                //we can change to a new event
+                pps = &rplotvec[plot_it->second];
             }
-        );
+        }else if(revent_stub.event.type != Event::Unknown){//entry not found - insert it
+            pps = &rplotvec[d.plotInsert(revent_stub.sender_rgb_color)];
+        }else{
+            drop_event_stub = true;
+        }
 
-        if(bin_srch_ret.first){//entry found
+        if(pps){
+            PlotStub        &rps = *pps;
+            const size_t    sample_count = revent_stub.events.size() + 1;
 
-            PlotStub &rps = rplotdq[bin_srch_ret.second];
+            if(rps.pending_pos >= sample_count){
+                rps.pending_pos = 0;
+            }
 
-            if(rps.ploted){
+            if(rps.pending_pos == 0 and revent_stub.event.type == Event::Unknown){//entry must be erased
+                d.plotErase(plot_it);
+                drop_event_stub = true;
+            }else{
+                //skip samples when accelerating - but never past the last one
+                rps.pending_pos += std::min(step - 1, sample_count - 1 - rps.pending_pos);
 
-                //we can change to a new event
-                if(rps.pending_pos < (revent_stub.events.size() + 1)){
-                    Event &revt = rps.pending_pos == 0 ? revent_stub.event : revent_stub.events[rps.pending_pos];
-
-                    if(revt.type == Event::Unknown){//entry must be erased
-                        rplotdq.erase(rplotdq.begin() + bin_srch_ret.second);
-                        drop_event_stub = true;
-                    }else{
-                        rps.ploted = false;
-                        rps.text = revent_stub.text;
-                        rps.x = revt.x;
-                        rps.y = revt.y;
-                        ++rps.pending_pos;
-                        if(rps.pending_pos >= (revent_stub.events.size() + 1)){
-                            rps.pending_pos = 0;
-                            drop_event_stub = true;
-                        }
-                    }
-                }
-            }
-        }else{//entry not found - insert it
-            Event &revt = revent_stub.event;
-            if(revt.type != Event::Unknown){//entry must be erased
-                PlotStub &rps = *(rplotdq.insert(rplotdq.begin() + bin_srch_ret.second, PlotStub{}));
-                rps.rgb_color = revent_stub.sender_rgb_color;
+                const Event &revt = rps.pending_pos == 0 ? revent_stub.event : revent_stub.events[rps.pending_pos - 1];
+
+                rps.ploted = false;
                 rps.text = revent_stub.text;
                 rps.x = revt.x;
                 rps.y = revt.y;
-                rps.pending_pos = 1;
-                rps.ploted = false;
-                if(rps.pending_pos >= (revent_stub.events.size() + 1)){
+                ++rps.pending_pos;
+                if(rps.pending_pos >= sample_count){
                     rps.pending_pos = 0;
                     drop_event_stub = true;
                 }
-            }else{
-                drop_event_stub = true;
             }
         }
 
         if(!drop_event_stub){
-            d.event_stubdq.push_back(std::move(revent_stub));
+            d.event_stubdq.push_back(std::move(rpending));
         }
 
         d.event_stubdq.pop_front();
     }
 
-    //now we need to make visible the d.plotdq we've just modified
+    d.plotgrid[d.write_plotvec_idx].build(rplotvec);
+
+    //now we need to make visible the d.plotvec we've just modified
     {
         std::unique_lock<std::mutex> lock(d.mtx);
-        while(d.read_plotdq_count){
+        while(d.read_plotvec_count){
             d.cnd.wait(lock);
         }
-        swap(d.write_plotdq_idx, d.read_plotdq_idx);
+        swap(d.write_plotvec_idx, d.read_plotvec_idx);
     }
 
-    d.plotdq[d.write_plotdq_idx] = d.plotdq[d.read_plotdq_idx];
+    d.plotvec[d.write_plotvec_idx] = d.plotvec[d.read_plotvec_idx];
 
-    for(auto& plot_stub: d.plotdq[d.write_plotdq_idx]){
+    for(auto& plot_stub: d.plotvec[d.write_plotvec_idx]){
         plot_stub.ploted = true;
     }
     if(!d.paused){
@@ -581,17 +1162,16 @@ void Engine::doProcessIncomingNotifications(solid::frame::ReactorContext &_rctx)
     }
 }
 
-void Engine::doTrySendEvents(){
-    solid_log(generic_logger, Info, "");
-    size_t      pop_eventq_idx = 0;
-    {
-        if(d.tmp_events_message_ptr){
-            SOLID_ASSERT(!d.events_message_ptr);
-            d.events_message_ptr = std::move(d.tmp_events_message_ptr);
-        }
-        
-        
-        if(d.events_message_ptr && !d.paused){
+void Engine::doTrySendEvents(solid::frame::ReactorContext &_rctx){
+    bubbles_log_sampled(generic_logger, Info, log_sample_count, "");
+
+    doFlushMoveEvent(_rctx);
+    d.reclaimSentMessages();
+
+    while(d.free_messagedq.size() && !d.paused){
+        size_t      pop_eventq_idx = 0;
+        size_t      queue_depth = 0;
+        {
             std::unique_lock<std::mutex> lock(d.mtx);
             //the message is ready to fill - see which of the eventq we should use
             if(d.discarded_on_push){
@@ -600,6 +1180,7 @@ void Engine::doTrySendEvents(){
                 d.discarded_on_push = false;
                 swap(d.pop_eventq_idx, d.push_eventq_idx);
                 pop_eventq_idx = d.pop_eventq_idx;
+                bubbles_log(generic_logger, Warning, "event queue overflow - dropped events so far: "<<d.dropped_event_count);
             }else if(d.eventq[d.pop_eventq_idx].size()){
                 //still have envents on popq
                 pop_eventq_idx = d.pop_eventq_idx;
@@ -610,47 +1191,87 @@ void Engine::doTrySendEvents(){
             }else{
                 pop_eventq_idx = -1;
             }
-        }else{
-            pop_eventq_idx = -1;
+            queue_depth = d.eventq[0].size() + d.eventq[1].size();
         }
-    }
-    if(pop_eventq_idx < 2 && d.events_message_ptr){
-        //we can fill events_message_ptr and send it to server
-        EventQueueT &reventq = d.eventq[pop_eventq_idx];
+
+        if(pop_eventq_idx >= 2){
+            break;
+        }
+
+        const SteadyTimePointT  now = std::chrono::steady_clock::now();
+        const SteadyTimePointT  send_time = d.nextSendTime(queue_depth);
+
+        if(send_time > now){
+            //let more events gather in the queue
+            if(!d.send_timer_armed){
+                d.send_timer_armed = true;
+                d.send_timer.waitUntil(
+                    _rctx, _rctx.steadyTime() + std::chrono::duration_cast<std::chrono::microseconds>(send_time - now),
+                    [this](solid::frame::ReactorContext &_rctx){
+                        d.send_timer_armed = false;
+                        doTrySendEvents(_rctx);
+                    }
+                );
+            }
+            break;
+        }
+
+        //we can fill a free message and send it to server
+        EventsNotificationPointerT  msg_ptr{std::move(d.free_messagedq.front())};
+        EventQueueT                 &reventq = d.eventq[pop_eventq_idx];
+
+        d.free_messagedq.pop_front();
 
         d.last_event = reventq.back();
 
-        d.events_message_ptr->event_stub.event = reventq.front();
+        msg_ptr->event_stub.event = reventq.front();
         reventq.pop();
 
-        while(reventq.size() && d.events_message_ptr->event_stub.events.size() < 1000){
-            d.events_message_ptr->event_stub.events.push_back(reventq.front());
+        while(reventq.size() && msg_ptr->event_stub.events.size() < 1000){
+            msg_ptr->event_stub.events.push_back(reventq.front());
             reventq.pop();
         }
 
-        std::shared_ptr<EventsNotification> tmp_ptr{std::move(d.events_message_ptr)};
-        solid::ErrorConditionT  err = d.rmpipc.sendMessage(d.server_endpoint.c_str(), tmp_ptr);
-        if(err){
-            solid_log(generic_logger, Error, ""<< " sendMessage error: "<<err.message());
+        if(!d.doSendMessage(std::move(msg_ptr))){
+            break;
         }
     }
 }
 
 void Engine::onConnectionStart(solid::frame::mpipc::ConnectionContext &_rctx){
-    solid_log(generic_logger, Info, _rctx.recipientId());
-    if(!d.paused){
-        d.mpipc_recipient = _rctx.recipientId();
-        auto msg_ptr = std::make_shared<RegisterRequest>(d.room_name, d.rgb_color);
+    bubbles_log(generic_logger, Info, _rctx.recipientId());
+    auto msg_ptr = std::make_shared<RegisterRequest>();
+
+    if(connectionStart(*msg_ptr)){
+        d.mpipc_transport_ptr->recipient_id = _rctx.recipientId();
         solid::ErrorConditionT  err;
         SOLID_CHECK(!(err = _rctx.service().sendMessage(_rctx.recipientId(), msg_ptr, {frame::mpipc::MessageFlagsE::WaitResponse})), "failed send message: "<<err.message());
     }else{
         auto lambda = [](solid::frame::mpipc::ConnectionContext &_rctx){};
-        d.rmpipc.forceCloseConnectionPool(_rctx.recipientId(), lambda);
+        _rctx.service().forceCloseConnectionPool(_rctx.recipientId(), lambda);
     }
 }
 
 void Engine::onConnectionStop(solid::frame::mpipc::ConnectionContext &_rctx){
-    solid_log(generic_logger, Info, _rctx.recipientId()<<' '<<_rctx.error().message()<<' '<<d.events_message_ptr);
+    bubbles_log(generic_logger, Info, _rctx.recipientId()<<' '<<_rctx.error().message());
+    connectionStop();
+}
+
+bool Engine::connectionStart(RegisterRequest &_rreq){
+    if(d.paused){
+        return false;
+    }
+    _rreq.room_name = d.room_name;
+    _rreq.rgb_color = d.rgb_color;
+    return true;
+}
+
+void Engine::connectionStop(){
+    d.registered = false;
+    {
+        std::unique_lock<std::mutex>    lock(d.mtx);
+        ++d.statistics.connection_stop_count;
+    }
     if(!d.paused){
         d.service.manager().notify(d.service.manager().id(*this), event_category.event(Events::ConnectionStopped));
     }
@@ -673,29 +1294,35 @@ void Engine::onMessage(
     solid::ErrorConditionT const &_rerror
 ){
 
-    solid_log(generic_logger, Info, _rctx.recipientId()<<" error: "<<_rerror.message());
+    bubbles_log(generic_logger, Info, _rctx.recipientId()<<" error: "<<_rerror.message());
 
-    if(d.paused) return;
+    if(_rrecv_msg_ptr && connectionRegistered(*_rrecv_msg_ptr)){
+        //after activation, the mpipc will start sending pending EventsNotification messages
+        _rctx.service().connectionNotifyEnterActiveState(_rctx.recipientId());
+    }
+}
+
+bool Engine::connectionRegistered(const RegisterResponse &_rres){
+    if(d.paused) return false;
 
-    if(_rrecv_msg_ptr && _rrecv_msg_ptr->success()){
-        d.rgb_color = _rrecv_msg_ptr->rgb_color;
+    if(_rres.success()){
+        d.rgb_color = _rres.rgb_color;
+        d.registered = true;
 
-        solid_log(generic_logger, Info, _rctx.recipientId()<<" MY COLOR: "<<d.rgb_color);
+        bubbles_log(generic_logger, Info, "MY COLOR: "<<d.rgb_color);
         //clear all events
         
         //NOTE: we cannot clear here - we must move to Engine's thread
-        //auto& rplotdq = d.plotdq[d.write_plotdq_idx];
-
-        //rplotdq.clear();
+        //d.plotClear();
         //d.event_stubdq.clear();
 
-        //after activation, the mpipc will start sending pending EventsNotification messages
-        _rctx.service().connectionNotifyEnterActiveState(_rctx.recipientId());
         d.service.manager().notify(d.service.manager().id(*this), generic_event_category.event(GenericEvents::Resume));
-    }else if(_rrecv_msg_ptr){
+        return true;
+    }else{
         //failed registering the connection
-        solid_log(generic_logger, Error, _rctx.recipientId()<<" Connection registration failed because ["<<_rrecv_msg_ptr->message<<"]. Exiting");
+        bubbles_log(generic_logger, Error, "Connection registration failed because ["<<_rres.message<<"]. Exiting");
         d.service.manager().notify(d.service.manager().id(*this), generic_event_category.event(GenericEvents::Stop));
+        return false;
     }
 }
 
@@ -705,24 +1332,56 @@ void Engine::onMessage(
     std::shared_ptr<EventsNotification> &_rrecv_msg_ptr,
     solid::ErrorConditionT const &_rerror
 ){
-    solid_log(generic_logger, Info, _rctx.recipientId()<<" error: "<<_rerror.message());
+    bubbles_log_sampled(generic_logger, Info, log_sample_count, _rctx.recipientId()<<" error: "<<_rerror.message());
     if(_rrecv_msg_ptr){
-        bool notify = false;
-        {
-            std::unique_lock<std::mutex>    lock(d.mtx);
-            EventsNotificationDequeT        &rmessagedq = d.messagedq[d.push_messagedq_idx];
+        eventsReceived(_rrecv_msg_ptr);
+    }else if(_rsent_msg_ptr){
+        eventsSent(_rsent_msg_ptr);
+    }
+}
 
-            rmessagedq.push_back(std::move(_rrecv_msg_ptr));
-            notify = (rmessagedq.size() == 1);
+void Engine::eventsReceived(std::shared_ptr<EventsNotification> &_rrecv_msg_ptr){
+    const SteadyTimePointT  now = std::chrono::steady_clock::now();
+    const uint64_t          now_usec = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+    bool                    notify = false;
+    {
+        std::unique_lock<std::mutex>    lock(d.mtx);
+        ReceivedStubDequeT              &rmessagedq = d.messagedq[d.push_messagedq_idx];
+
+        ++d.statistics.received_message_count;
+        d.statistics.received_event_count += _rrecv_msg_ptr->event_stub.events.size() + 1;
+        d.recordLatency(_rrecv_msg_ptr->event_stub, now_usec);
+        for(const auto &revent_stub: _rrecv_msg_ptr->event_stubs){
+            d.statistics.received_event_count += revent_stub.events.size() + 1;
+            d.recordLatency(revent_stub, now_usec);
         }
 
-        if(notify){
-            d.service.manager().notify(d.service.manager().id(*this), generic_event_category.event(GenericEvents::Message));
-        }
-    }else if(_rsent_msg_ptr){
-        _rsent_msg_ptr->clear();
-        SOLID_ASSERT(!d.tmp_events_message_ptr);
-        d.tmp_events_message_ptr = std::move(_rsent_msg_ptr);
+        rmessagedq.emplace_back(std::move(_rrecv_msg_ptr), now);
+        notify = (rmessagedq.size() == 1);
+    }
+
+    if(notify){
+        d.service.manager().notify(d.service.manager().id(*this), generic_event_category.event(GenericEvents::Message));
+    }
+}
+
+void Engine::eventsSent(std::shared_ptr<EventsNotification> &_rsent_msg_ptr, const bool _round_trip){
+    const SteadyTimePointT  now = std::chrono::steady_clock::now();
+    const size_t            event_count = _rsent_msg_ptr->event_stub.events.size() + 1;
+    bool                    notify = false;
+
+    _rsent_msg_ptr->clear();
+    {
+        std::unique_lock<std::mutex>    lock(d.mtx);
+
+        ++d.statistics.sent_message_count;
+        d.statistics.sent_event_count += event_count;
+
+        d.sent_stubdq.emplace_back(std::move(_rsent_msg_ptr), now, _round_trip);
+        notify = (d.sent_stubdq.size() == 1);
+    }
+
+    if(notify){
         d.service.manager().notify(d.service.manager().id(*this), generic_event_category.event(GenericEvents::Raise));
     }
 }
@@ -733,7 +1392,21 @@ void Engine::onMessage(
     std::shared_ptr<EventsNotificationResponse> &_rrecv_msg_ptr,
     solid::ErrorConditionT const &_rerror
 ){
-    solid_log(generic_logger, Info, _rctx.recipientId()<<" error: "<<_rerror.message());
+    bubbles_log_sampled(generic_logger, Info, log_sample_count, _rctx.recipientId()<<" error: "<<_rerror.message());
+    if(_rsent_msg_ptr){
+        //no response on error - then it is not a round trip
+        std::shared_ptr<EventsNotification> msg_ptr(std::move(_rsent_msg_ptr));
+        eventsSent(msg_ptr, _rrecv_msg_ptr != nullptr);
+    }
+}
+
+void Engine::onMessage(
+    solid::frame::mpipc::ConnectionContext &_rctx,
+    std::shared_ptr<SuspendNotification> &_rsent_msg_ptr,
+    std::shared_ptr<SuspendNotification> &_rrecv_msg_ptr,
+    solid::ErrorConditionT const &_rerror
+){
+    bubbles_log(generic_logger, Info, _rctx.recipientId()<<" error: "<<_rerror.message());
 }
 
 
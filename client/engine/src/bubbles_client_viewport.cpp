@@ -0,0 +1,78 @@
+#include "client/engine/bubbles_client_viewport.hpp"
+
+namespace bubbles{
+namespace client{
+
+Viewport::Viewport(
+    const int32_t _canvas_width, const int32_t _canvas_height,
+    const int32_t _width, const int32_t _height
+):  canvas_width(_canvas_width), canvas_height(_canvas_height),
+    view_width(_width), view_height(_height), zoom_factor(fixed_one),
+    center_x(0), center_y(0), scale_x(0), scale_y(0)
+{
+    update();
+}
+
+void Viewport::canvas(const int32_t _canvas_width, const int32_t _canvas_height){
+    canvas_width = _canvas_width;
+    canvas_height = _canvas_height;
+    update();
+}
+
+void Viewport::resize(const int32_t _width, const int32_t _height){
+    view_width = _width;
+    view_height = _height;
+    update();
+}
+
+void Viewport::zoom(const int32_t _zoom){
+    zoom_factor = _zoom > 0 ? _zoom : 1;
+    update();
+}
+
+void Viewport::center(const int32_t _x, const int32_t _y){
+    center_x = _x;
+    center_y = _y;
+}
+
+void Viewport::pan(const int32_t _dx, const int32_t _dy){
+    if(scale_x){
+        center_x -= static_cast<int32_t>((static_cast<int64_t>(_dx) << fixed_shift) / scale_x);
+    }
+    if(scale_y){
+        center_y -= static_cast<int32_t>((static_cast<int64_t>(_dy) << fixed_shift) / scale_y);
+    }
+}
+
+void Viewport::canvasBounds(
+    const int32_t _margin,
+    int32_t &_rleft, int32_t &_rtop, int32_t &_rright, int32_t &_rbottom
+)const{
+    _rleft = reverseX(-(view_width/2) - _margin);
+    _rright = reverseX(view_width - view_width/2 + _margin);
+    _rtop = reverseY(-(view_height/2) - _margin);
+    _rbottom = reverseY(view_height - view_height/2 + _margin);
+}
+
+void Viewport::update(){
+    //(viewport / canvas) * zoom, kept in 16.16
+    scale_x = canvas_width > 0 ? ((static_cast<int64_t>(view_width) * zoom_factor) / canvas_width) : 0;
+    scale_y = canvas_height > 0 ? ((static_cast<int64_t>(view_height) * zoom_factor) / canvas_height) : 0;
+}
+
+void Viewport::transform(PlotEntry *_pentries, const size_t _count)const{
+    //copy the members to locals so the compiler knows they cannot alias the entries
+    const int64_t cx = center_x;
+    const int64_t cy = center_y;
+    const int64_t sx = scale_x;
+    const int64_t sy = scale_y;
+
+    for(size_t i = 0; i < _count; ++i){
+        PlotEntry &rentry = _pentries[i];
+        rentry.x = static_cast<int32_t>(((rentry.x - cx) * sx) >> fixed_shift);
+        rentry.y = static_cast<int32_t>(((rentry.y - cy) * sy) >> fixed_shift);
+    }
+}
+
+}//namespace client
+}//namespace bubbles
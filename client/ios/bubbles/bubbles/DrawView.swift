@@ -15,6 +15,8 @@ class DrawView: UIView {
     let remote_diameter: CGFloat = 30.0
     
     var has_touch = false
+    //scaled plot, filled by the engine in one call per frame
+    var plot_entries = [EnginePlotEntry](repeating: EnginePlotEntry(), count: 256)
     
     override init(frame: CGRect) {
         super.init(frame: frame)
@@ -46,7 +48,7 @@ class DrawView: UIView {
         //os_log("DrawView: x = %@; y = %@", log: OSLog.default, type: .debug, position.x.description, position.y.description)
         let x = engine_reverse_scale_x(((position.x - self.bounds.width/2) as NSNumber).int32Value, Int32(self.bounds.width))
         let y = engine_reverse_scale_y(((position.y - self.bounds.height/2) as NSNumber).int32Value, Int32(self.bounds.height))
-        engine_move(x, y)
+        engine_move_end(x, y)
         position.x = CGFloat(x)
         position.y = CGFloat(y)
         self.setNeedsDisplay()
@@ -85,7 +87,11 @@ class DrawView: UIView {
         //os_log("drawCircle: x = %@; y = %@; c = %@; d = %@", log: OSLog.default, type: .debug, x.description, y.description, color.description, diameter.description)
         let nx = engine_scale_x(x, Int32(floor(self.bounds.width)))
         let ny = engine_scale_y(y, Int32(floor(self.bounds.height)))
-        let path = UIBezierPath(ovalIn: CGRect(x: CGFloat(nx) + self.center.x - diameter/2, y: CGFloat(ny) + self.center.y - diameter/2, width: diameter, height: diameter))
+        drawScaledCircle(x: nx, y: ny, color: color, diameter: diameter)
+    }
+    
+    func drawScaledCircle(x: Int32, y: Int32, color: Int32, diameter: CGFloat){
+        let path = UIBezierPath(ovalIn: CGRect(x: CGFloat(x) + self.center.x - diameter/2, y: CGFloat(y) + self.center.y - diameter/2, width: diameter, height: diameter))
         let ncolor = uiColorFromHex(rgbValue: color)
         ncolor.setStroke()
         ncolor.setFill()
@@ -94,26 +100,31 @@ class DrawView: UIView {
         path.fill()
     }
     
+    func copyPlot() -> Int {
+        let w = Int32(floor(self.bounds.width))
+        let h = Int32(floor(self.bounds.height))
+        var count = Int(plot_entries.withUnsafeMutableBufferPointer { engine_plot_copy($0.baseAddress, Int32($0.count), w, h) })
+        if count > plot_entries.count {
+            //grow and copy again - the plot might have changed meanwhile
+            plot_entries = [EnginePlotEntry](repeating: EnginePlotEntry(), count: count * 2)
+            count = Int(plot_entries.withUnsafeMutableBufferPointer { engine_plot_copy($0.baseAddress, Int32($0.count), w, h) })
+        }
+        return min(count, plot_entries.count)
+    }
     
     // Only override draw() if you perform custom drawing.
     // An empty implementation adversely affects performance during animation.
     override func draw(_ rect: CGRect) {
         //os_log("draw", log: OSLog.default, type: .debug)
-        engine_plot_start()
-        
-        let my_color = engine_plot_my_color()
+        let my_color = engine_my_color()
+        let count = copyPlot()
         
-        while engine_plot_end() != 1{
-            let x = engine_plot_x()
-            let y = engine_plot_y()
-            let c = engine_plot_color()
-            
-            drawCircle(x:x, y:y, color:c, diameter:remote_diameter)
-            engine_plot_next()
+        for i in 0..<count {
+            let entry = plot_entries[i]
+            drawScaledCircle(x: entry.x, y: entry.y, color: entry.color, diameter: remote_diameter)
         }
         
         drawCircle(x: (position.x as NSNumber).int32Value, y:(position.y as NSNumber).int32Value, color:my_color, diameter:local_diameter)
-        engine_plot_done()
     }
     
     func autoMove(x: Int32, y: Int32){
@@ -30,6 +30,7 @@
 
 #include "protocol/bubbles_messages.hpp"
 #include "client/engine/bubbles_client_engine.hpp"
+#include "client/engine/bubbles_client_message_setup.hpp"
 
 
 using namespace std;
@@ -70,89 +71,6 @@ namespace {
 
 
 //-----------------------------------------------------------------------------
-namespace bubbles{
-    namespace client{
-        
-        struct MessageSetup {
-            Engine &engine;
-
-            MessageSetup(Engine &_engine):engine(_engine){}
-            
-            void operator()(bubbles::ProtocolT& _rprotocol, TypeToType<RegisterRequest> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
-            {
-                Engine &eng = engine;
-                auto lambda = [&eng](
-                    frame::mpipc::ConnectionContext &_rctx,
-                    std::shared_ptr<RegisterRequest> &_rsent_msg_ptr,
-                    std::shared_ptr<RegisterResponse> &_rrecv_msg_ptr,
-                    ErrorConditionT const &_rerror
-                ){
-                    eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
-                };
-                _rprotocol.registerMessage<RegisterRequest>(lambda, _rtid);
-            }
-            
-            void operator()(bubbles::ProtocolT& _rprotocol, TypeToType<RegisterResponse> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
-            {
-                Engine &eng = engine;
-                auto lambda = [&eng](
-                    frame::mpipc::ConnectionContext &_rctx,
-                    std::shared_ptr<RegisterRequest> &_rsent_msg_ptr,
-                    std::shared_ptr<RegisterResponse> &_rrecv_msg_ptr,
-                    ErrorConditionT const &_rerror
-                ){
-                    eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
-                };
-                _rprotocol.registerMessage<RegisterResponse>(lambda, _rtid);
-            }
-            
-            void operator()(bubbles::ProtocolT& _rprotocol, TypeToType<EventsNotificationRequest> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
-            {
-                Engine &eng = engine;
-                auto lambda = [&eng](
-                    frame::mpipc::ConnectionContext &_rctx,
-                    std::shared_ptr<EventsNotificationRequest> &_rsent_msg_ptr,
-                    std::shared_ptr<EventsNotificationResponse> &_rrecv_msg_ptr,
-                    ErrorConditionT const &_rerror
-                ){
-                    eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
-                };
-                _rprotocol.registerMessage<EventsNotificationRequest>(lambda, _rtid);
-            }
-            
-            void operator()(bubbles::ProtocolT& _rprotocol, TypeToType<EventsNotificationResponse> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
-            {
-                Engine &eng = engine;
-                auto lambda = [&eng](
-                    frame::mpipc::ConnectionContext &_rctx,
-                    std::shared_ptr<EventsNotificationRequest> &_rsent_msg_ptr,
-                    std::shared_ptr<EventsNotificationResponse> &_rrecv_msg_ptr,
-                    ErrorConditionT const &_rerror
-                ){
-                    eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
-                };
-                _rprotocol.registerMessage<EventsNotificationResponse>(lambda, _rtid);
-            }
-            
-            template <typename T>
-            void operator()(bubbles::ProtocolT& _rprotocol, TypeToType<T> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
-            {
-                Engine &eng = engine;
-                auto lambda = [&eng](
-                    frame::mpipc::ConnectionContext &_rctx,
-                    std::shared_ptr<T> &_rsent_msg_ptr,
-                    std::shared_ptr<T> &_rrecv_msg_ptr,
-                    ErrorConditionT const &_rerror
-                ){
-                    eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
-                };
-                _rprotocol.registerMessage<T>(lambda, _rtid);
-            }
-        };
-        
-    }//namespace client
-}//namespace bubbles
-
 
 int engine_start(
     const char *_host,
@@ -177,7 +95,17 @@ int engine_start(
     string client_cert_str{_ssl_client_cert};
     string client_key_str{_ssl_client_key};
     
-    g_ctx.engine_ptr = bubbles::client::Engine::create(g_ctx.svc, g_ctx.ipcsvc, bubbles::client::EngineConfiguration{});
+    {
+        bubbles::client::EngineConfiguration engine_cfg;
+        
+        //fewer, bigger messages - spare the radio wakeups
+        engine_cfg.move_min_distance = 16;
+        engine_cfg.move_min_interval_msec = 16;
+        engine_cfg.send_window_size = 2;
+        engine_cfg.send_batch_interval_msec = 50;
+        
+        g_ctx.engine_ptr = bubbles::client::Engine::create(g_ctx.svc, g_ctx.ipcsvc, engine_cfg);
+    }
     
     ErrorConditionT         err;
     auto thr_enter = []() {
@@ -298,6 +226,10 @@ void engine_move(int _x, int _y){
     g_ctx.engine_ptr->moveEvent(_x, _y);
 }
 
+void engine_move_end(int _x, int _y){
+    g_ctx.engine_ptr->moveEvent(_x, _y, true);
+}
+
 void engine_plot_start(){
     g_ctx.plotit = g_ctx.engine_ptr->plot();
 }
@@ -341,6 +273,23 @@ int engine_plot_my_color(){
     return swift_color(g_ctx.plotit.myRgbColor());
 }
 
+int engine_my_color(){
+    return swift_color(g_ctx.engine_ptr->myRgbColor());
+}
+
+int engine_plot_copy(EnginePlotEntry *_pentries, int _capacity, int _w, int _h){
+    static_assert(sizeof(EnginePlotEntry) == sizeof(bubbles::client::PlotEntry), "EnginePlotEntry must map on PlotEntry");
+    
+    const size_t    capacity = _capacity > 0 ? _capacity : 0;
+    auto            pentries = reinterpret_cast<bubbles::client::PlotEntry*>(_pentries);
+    const size_t    count = g_ctx.engine_ptr->plotCopy(pentries, capacity, _w, _h);
+    
+    for(size_t i = 0; i < count && i < capacity; ++i){
+        _pentries[i].color = swift_color(pentries[i].rgb_color);
+    }
+    return static_cast<int>(count);
+}
+
 int engine_scale_x(int _x, int _w){
     return g_ctx.engine_ptr->scaleX(_x, _w);
 }
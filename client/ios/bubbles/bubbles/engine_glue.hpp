@@ -20,6 +20,12 @@ extern "C"{
     typedef void (*GUIUpdateCallbackT)(void*);
     typedef void (*AutoUpdateCallbackT)(void*,int, int);
     
+    typedef struct{
+        int x;
+        int y;
+        int color;
+    } EnginePlotEntry;
+    
     int engine_start(
         const char  *_host,
         const char  *_room,
@@ -35,6 +41,7 @@ extern "C"{
     );
     
     void engine_move(int _x, int _y);
+    void engine_move_end(int _x, int _y);
     
     void engine_plot_start();
     void engine_plot_done();
@@ -45,6 +52,11 @@ extern "C"{
     int engine_plot_color();
     int engine_plot_my_color();
     
+    int engine_my_color();
+    //copy at most _capacity scaled plot entries in one call
+    //returns the number of plotted peers which can exceed _capacity
+    int engine_plot_copy(EnginePlotEntry *_pentries, int _capacity, int _w, int _h);
+    
     int engine_scale_x(int _x, int _w);
     int engine_scale_y(int _y, int _h);
     
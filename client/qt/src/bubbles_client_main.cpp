@@ -18,6 +18,7 @@
 
 
 #include "client/engine/bubbles_client_engine.hpp"
+#include "client/engine/bubbles_client_message_setup.hpp"
 
 #include "protocol/bubbles_messages.hpp"
 
@@ -61,6 +62,10 @@ struct Parameters{
     bool                    secure;
     bool                    compress;
     bool                    auto_pilot;
+    size_t                  move_min_distance;
+    size_t                  move_min_interval_msec;
+    size_t                  send_window_size;
+    size_t                  send_batch_interval_msec;
 
     string                  connect_endpoint;
     string                  connect_addr;
@@ -69,90 +74,6 @@ struct Parameters{
     string                  room_name;
 };
 
-//-----------------------------------------------------------------------------
-namespace bubbles{
-namespace client{
-
-struct MessageSetup {
-    Engine &engine;
-
-    MessageSetup(Engine &_engine):engine(_engine){}
-    
-    void operator()(bubbles::ProtocolT& _rprotocol, TypeToType<RegisterRequest> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
-    {
-        Engine &eng = engine;
-        auto lambda = [&eng](
-            frame::mpipc::ConnectionContext &_rctx,
-            std::shared_ptr<RegisterRequest> &_rsent_msg_ptr,
-            std::shared_ptr<RegisterResponse> &_rrecv_msg_ptr,
-            ErrorConditionT const &_rerror
-        ){
-            eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
-        };
-        _rprotocol.registerMessage<RegisterRequest>(lambda, _rtid);
-    }
-    
-    void operator()(bubbles::ProtocolT& _rprotocol, TypeToType<RegisterResponse> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
-    {
-        Engine &eng = engine;
-        auto lambda = [&eng](
-            frame::mpipc::ConnectionContext &_rctx,
-            std::shared_ptr<RegisterRequest> &_rsent_msg_ptr,
-            std::shared_ptr<RegisterResponse> &_rrecv_msg_ptr,
-            ErrorConditionT const &_rerror
-        ){
-            eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
-        };
-        _rprotocol.registerMessage<RegisterResponse>(lambda, _rtid);
-    }
-    
-    void operator()(bubbles::ProtocolT& _rprotocol, TypeToType<EventsNotificationRequest> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
-    {
-        Engine &eng = engine;
-        auto lambda = [&eng](
-            frame::mpipc::ConnectionContext &_rctx,
-            std::shared_ptr<EventsNotificationRequest> &_rsent_msg_ptr,
-            std::shared_ptr<EventsNotificationResponse> &_rrecv_msg_ptr,
-            ErrorConditionT const &_rerror
-        ){
-            eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
-        };
-        _rprotocol.registerMessage<EventsNotificationRequest>(lambda, _rtid);
-    }
-    
-    void operator()(bubbles::ProtocolT& _rprotocol, TypeToType<EventsNotificationResponse> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
-    {
-        Engine &eng = engine;
-        auto lambda = [&eng](
-            frame::mpipc::ConnectionContext &_rctx,
-            std::shared_ptr<EventsNotificationRequest> &_rsent_msg_ptr,
-            std::shared_ptr<EventsNotificationResponse> &_rrecv_msg_ptr,
-            ErrorConditionT const &_rerror
-        ){
-            eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
-        };
-        _rprotocol.registerMessage<EventsNotificationResponse>(lambda, _rtid);
-    }
-    
-    template <typename T>
-    void operator()(bubbles::ProtocolT& _rprotocol, TypeToType<T> _t2t, const bubbles::ProtocolT::TypeIdT& _rtid)
-    {
-        Engine &eng = engine;
-        auto lambda = [&eng](
-            frame::mpipc::ConnectionContext &_rctx,
-            std::shared_ptr<T> &_rsent_msg_ptr,
-            std::shared_ptr<T> &_rrecv_msg_ptr,
-            ErrorConditionT const &_rerror
-        ){
-            eng.onMessage(_rctx, _rsent_msg_ptr, _rrecv_msg_ptr, _rerror);
-        };
-        _rprotocol.registerMessage<T>(lambda, _rtid);
-    }
-};
-
-}//namespace client
-}//namespace bubbles
-
 //-----------------------------------------------------------------------------
 
 bool parseArguments(Parameters &_par, int argc, char *argv[]);
@@ -202,7 +123,14 @@ int main(int argc, char *argv[]){
     frame::aio::Resolver                resolver;
 
     ErrorConditionT                     err;
-    bubbles::client::Engine::PointerT   engine_ptr{bubbles::client::Engine::create(service, ipcservice, bubbles::client::EngineConfiguration{})};
+    bubbles::client::EngineConfiguration engine_cfg;
+
+    engine_cfg.move_min_distance = params.move_min_distance;
+    engine_cfg.move_min_interval_msec = params.move_min_interval_msec;
+    engine_cfg.send_window_size = params.send_window_size;
+    engine_cfg.send_batch_interval_msec = params.send_batch_interval_msec;
+
+    bubbles::client::Engine::PointerT   engine_ptr{bubbles::client::Engine::create(service, ipcservice, engine_cfg)};
 
     bubbles::client::Widget             widget{engine_ptr};
 
@@ -316,6 +244,10 @@ bool parseArguments(Parameters &_par, int argc, char *argv[]){
             ("secure,s", value<bool>(&_par.secure)->implicit_value(true)->default_value(true), "Use SSL to secure communication")
             ("compress", value<bool>(&_par.compress)->implicit_value(true)->default_value(true), "Use Snappy to compress communication")
             ("auto,a", value<bool>(&_par.auto_pilot)->implicit_value(true)->default_value(true), "Auto randomly move the bubble")
+            ("move-min-distance", value<size_t>(&_par.move_min_distance)->default_value(0), "Drop pointer samples closer than this (canvas units) to the last sent one")
+            ("move-min-msec", value<size_t>(&_par.move_min_interval_msec)->default_value(16), "Drop pointer samples sooner than this (milliseconds) after the last sent one")
+            ("send-window", value<size_t>(&_par.send_window_size)->default_value(4), "Maximum position update messages in flight")
+            ("send-batch-msec", value<size_t>(&_par.send_batch_interval_msec)->default_value(0), "Minimum milliseconds between position update messages - 0 for lowest latency")
         ;
         variables_map vm;
         store(parse_command_line(argc, argv, desc), vm);
@@ -0,0 +1,160 @@
+#include "bubbles_client_renderer.hpp"
+
+namespace bubbles{
+namespace client{
+
+void split_color(uint32_t _c, uint32_t &_r, uint32_t &_g, uint32_t &_b){
+    _r = _c & 0xff;
+    _g = (_c >> 8) & 0xff;
+    _b = (_c >> 16) & 0xff;
+}
+
+namespace{
+
+//draw a bubble centered in a _size x _size square at _origin
+void draw_bubble(QPainter &_rpainter, const QPoint &_origin, const int _size, const int _diameter, const uint32_t _rgb_color){
+    uint32_t        r;
+    uint32_t        g;
+    uint32_t        b;
+    const int       offset = (_size - _diameter) / 2;
+
+    split_color(_rgb_color, r, g, b);
+    _rpainter.setPen(QPen(QColor(r, g, b), 3));
+    _rpainter.setBrush(QBrush(QColor(r, g, b)));
+    _rpainter.drawEllipse(QRect(_origin.x() + offset, _origin.y() + offset, _diameter, _diameter));
+}
+
+}//namespace
+
+Renderer::Renderer():antialiased(true), sprite_atlas_size(0), frame_count(0), evict_frame(0), my_sprite_color(0){}
+
+void Renderer::setAntialiased(const bool _antialiased){
+    if(antialiased != _antialiased){
+        antialiased = _antialiased;
+        clear();
+    }
+}
+
+void Renderer::clear(){
+    sprite_map.clear();
+    free_indexes.clear();
+    sprite_atlas_size = 0;
+    sprite_atlas.fill(Qt::transparent);
+    my_sprite = QPixmap();
+}
+
+//index of the atlas cell holding the pre-rendered bubble of the given color
+int Renderer::spriteIndex(const uint32_t _rgb_color){
+    auto it = sprite_map.find(_rgb_color);
+    if(it != sprite_map.end()){
+        it->second.frame = frame_count;
+        return it->second.index;
+    }
+
+    int index;
+
+    if(free_indexes.size()){
+        index = free_indexes.back();
+        free_indexes.pop_back();
+    }else{
+        const int capacity = (sprite_atlas.height() / sprite_size) * sprite_atlas_columns;
+
+        index = sprite_atlas_size++;
+
+        if(index >= capacity){
+            //grow the atlas keeping the sprites already rendered
+            const int   rows = capacity ? (capacity / sprite_atlas_columns) * 2 : 4;
+            QPixmap     atlas(sprite_atlas_columns * sprite_size, rows * sprite_size);
+
+            atlas.fill(Qt::transparent);
+            if(capacity){
+                QPainter painter(&atlas);
+                painter.drawPixmap(0, 0, sprite_atlas);
+            }
+            sprite_atlas = atlas;
+        }
+    }
+
+    {
+        const QPoint    origin = spriteOrigin(index);
+        QPainter        painter(&sprite_atlas);
+
+        //a reused cell still holds the evicted sprite
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.fillRect(origin.x(), origin.y(), sprite_size, sprite_size, Qt::transparent);
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        painter.setRenderHint(QPainter::Antialiasing, antialiased);
+        draw_bubble(painter, origin, sprite_size, 20, _rgb_color);
+    }
+
+    sprite_map[_rgb_color] = SpriteStub{index, frame_count};
+    return index;
+}
+
+//colors of peers long gone pile up - give back the cells of the sprites not drawn lately
+void Renderer::evictIdleSprites(){
+    evict_frame = frame_count;
+    for(auto it = sprite_map.begin(); it != sprite_map.end();){
+        if((frame_count - it->second.frame) > sprite_max_idle_frames){
+            free_indexes.push_back(it->second.index);
+            it = sprite_map.erase(it);
+        }else{
+            ++it;
+        }
+    }
+}
+
+QPoint Renderer::spriteOrigin(const int _index)const{
+    return QPoint((_index % sprite_atlas_columns) * sprite_size, (_index / sprite_atlas_columns) * sprite_size);
+}
+
+void Renderer::drawPlot(QPainter &_rpainter, const PlotEntry *_pentries, const size_t _count, const QRect &_rclip_rect){
+    const QRect clip_rect = _rclip_rect.adjusted(-sprite_size, -sprite_size, sprite_size, sprite_size);
+
+    ++frame_count;
+
+    //sweep at most once per sprite_max_idle_frames - a busy atlas is not scanned on every frame
+    if(sprite_map.size() > max_sprite_count and (frame_count - evict_frame) > sprite_max_idle_frames){
+        evictIdleSprites();
+    }
+
+    //make sure all sprites are in the atlas before building the fragments - the atlas might grow
+    for(size_t i = 0; i < _count; ++i){
+        spriteIndex(_pentries[i].rgb_color);
+    }
+
+    fragments.clear();
+    for(size_t i = 0; i < _count; ++i){
+        const PlotEntry &rentry = _pentries[i];
+
+        if(!clip_rect.contains(rentry.x, rentry.y)){
+            continue;
+        }
+
+        const QPoint    origin = spriteOrigin(sprite_map[rentry.rgb_color].index);
+
+        fragments.push_back(
+            QPainter::PixmapFragment::create(
+                QPointF(rentry.x, rentry.y),
+                QRectF(origin.x(), origin.y(), sprite_size, sprite_size)
+            )
+        );
+    }
+    //all remote bubbles in one blit call
+    _rpainter.drawPixmapFragments(fragments.data(), fragments.size(), sprite_atlas);
+}
+
+void Renderer::drawLocal(QPainter &_rpainter, const int _x, const int _y, const uint32_t _rgb_color){
+    if(my_sprite.isNull() or my_sprite_color != _rgb_color){
+        my_sprite = QPixmap(my_sprite_size, my_sprite_size);
+        my_sprite.fill(Qt::transparent);
+        QPainter sprite_painter(&my_sprite);
+        sprite_painter.setRenderHint(QPainter::Antialiasing, antialiased);
+        draw_bubble(sprite_painter, QPoint(0, 0), my_sprite_size, 40, _rgb_color);
+        my_sprite_color = _rgb_color;
+    }
+    _rpainter.drawPixmap(_x - my_sprite_size/2, _y - my_sprite_size/2, my_sprite);
+}
+
+}//namespace client
+}//namespace bubbles
@@ -0,0 +1,72 @@
+#ifndef BUBBLES_CLIENT_RENDERER_HPP
+#define BUBBLES_CLIENT_RENDERER_HPP
+
+#include <QPainter>
+#include <QPixmap>
+#include <vector>
+#include <unordered_map>
+#include "client/engine/bubbles_client_viewport.hpp"
+
+namespace bubbles{
+namespace client{
+
+//Draws a plot snapshot using pre-rendered bubble sprites.
+//Every color is rasterized once into a cell of a sprite atlas and
+//all the remote bubbles are then drawn with a single blit call.
+//Every sprite is stamped with the last frame that used it. Once the atlas holds more
+//than max_sprite_count sprites, the ones idle for sprite_max_idle_frames give their
+//cells back. The atlas grows to fit the colors of a single frame, however many.
+//The painter origin must be in the viewport center.
+class Renderer{
+public:
+    static const int    sprite_size = 24;//a 20 pixels bubble with a 3 pixels pen
+    static const int    my_sprite_size = 44;
+
+    Renderer();
+
+    void setAntialiased(const bool _antialiased);
+
+    bool isAntialiased()const{
+        return antialiased;
+    }
+
+    void clear();
+
+    //draw the entries whose center is within _rclip_rect (grown by a sprite)
+    void drawPlot(QPainter &_rpainter, const PlotEntry *_pentries, const size_t _count, const QRect &_rclip_rect);
+    void drawLocal(QPainter &_rpainter, const int _x, const int _y, const uint32_t _rgb_color);
+private:
+    int spriteIndex(const uint32_t _rgb_color);
+    QPoint spriteOrigin(const int _index)const;
+    void evictIdleSprites();
+private:
+    struct SpriteStub{
+        int         index;//sprite_atlas cell
+        uint64_t    frame;//last frame drawing the sprite
+    };
+
+    using SpriteMapT = std::unordered_map<uint32_t, SpriteStub>;
+    using FragmentVectorT = std::vector<QPainter::PixmapFragment>;
+    using IndexVectorT = std::vector<int>;
+
+    static const int        sprite_atlas_columns = 32;
+    static const size_t     max_sprite_count = 4096;//eviction starts above this
+    static const uint64_t   sprite_max_idle_frames = 64;
+
+    bool                antialiased;
+    QPixmap             sprite_atlas;//pre-rendered bubble of every color in sprite_map
+    SpriteMapT          sprite_map;//rgb_color -> sprite_atlas cell
+    IndexVectorT        free_indexes;//sprite_atlas cells given back by evictIdleSprites
+    int                 sprite_atlas_size;//used sprite_atlas cells, free ones included
+    uint64_t            frame_count;
+    uint64_t            evict_frame;//frame of the last evictIdleSprites
+    FragmentVectorT     fragments;
+    QPixmap             my_sprite;
+    uint32_t            my_sprite_color;
+};
+
+void split_color(uint32_t _c, uint32_t &_r, uint32_t &_g, uint32_t &_b);
+
+}//namespace client
+}//namespace bubbles
+#endif
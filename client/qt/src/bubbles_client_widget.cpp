@@ -3,19 +3,32 @@
 
 #include <QPainter>
 #include <QMouseEvent>
+#include <QWheelEvent>
+#include <QPaintEvent>
 #include <QTextStream>
+#include <QGuiApplication>
+#include <QScreen>
 
 #include <stdlib.h>
+#include <algorithm>
 
 namespace bubbles{
 namespace client{
 
 Widget::Widget(Engine::PointerT &_engine_ptr, QWidget *parent)
-    : QWidget(parent), engine_ptr(_engine_ptr)
+    : QWidget(parent), engine_ptr(_engine_ptr), viewport(_engine_ptr->viewport(width(), height())), plot_entries(256), plot_count(0), full_repaint(true)
 {
-    antialiased = true;
+    {
+        const QScreen   *pscreen = QGuiApplication::primaryScreen();
+        const qreal     refresh_rate = pscreen && pscreen->refreshRate() > 1 ? pscreen->refreshRate() : 60;
 
-    connect(this, SIGNAL(updateSignal()), this, SLOT(update()), Qt::QueuedConnection);
+        frame_timer.setSingleShot(true);
+        frame_timer.setTimerType(Qt::PreciseTimer);
+        frame_timer.setInterval(std::max(1, static_cast<int>(1000 / refresh_rate)));
+    }
+
+    connect(&frame_timer, SIGNAL(timeout()), this, SLOT(onFrame()));
+    connect(this, SIGNAL(updateSignal()), this, SLOT(scheduleFrame()), Qt::QueuedConnection);
     connect(this, SIGNAL(closeSignal()), this, SLOT(close()), Qt::QueuedConnection);
     connect(this, SIGNAL(autoMoveSignal()), this, SLOT(autoMoveEvent()), Qt::QueuedConnection);
 
@@ -26,12 +39,16 @@ Widget::Widget(Engine::PointerT &_engine_ptr, QWidget *parent)
     setBackgroundRole(QPalette::Base);
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     moving = false;
+    panning = false;
+    status_x = 0;
+    status_y = 0;
+    status_text.setTextFormat(Qt::PlainText);
 }
 
 void Widget::setAntialiased(bool antialiased)
 {
-    this->antialiased = antialiased;
-    update();
+    renderer.setAntialiased(antialiased);
+    invalidateFrame();
 }
 
 QSize Widget::minimumSizeHint() const
@@ -44,100 +61,210 @@ QSize Widget::sizeHint() const
     return QSize(1280/2, 720/2);
 }
 
-void split_color(uint32_t _c, uint32_t &_r, uint32_t &_g, uint32_t &_b){
-    _r = _c & 0xff;
-    _g = (_c >> 8) & 0xff;
-    _b = (_c >> 16) & 0xff;
-}
-
 void Widget::start(){
     engine_ptr->moveEvent(pos.x(), pos.y());
     show();
+    scheduleFrame();
+}
+
+void Widget::scheduleFrame(){
+    //at most one frame per display refresh - the updates coming meanwhile are merged
+    if(!frame_timer.isActive()){
+        frame_timer.start();
+    }
+}
+
+void Widget::invalidateFrame(){
+    full_repaint = true;
+    scheduleFrame();
+}
+
+QRect Widget::bubbleRect(const int _x, const int _y, const int _size)const{
+    return QRect(_x + width()/2 - _size/2, _y + height()/2 - _size/2, _size, _size);
+}
+
+//take a new snapshot of the plot and repaint only what changed since the last one
+void Widget::onFrame(){
+    size_t count = engine_ptr->plotCopy(plot_entries.data(), plot_entries.size(), viewport);
+
+    if(count > plot_entries.size()){
+        plot_entries.resize(count * 2);
+        count = engine_ptr->plotCopy(plot_entries.data(), plot_entries.size(), viewport);
+        if(count > plot_entries.size()){
+            count = plot_entries.size();
+        }
+    }
+    plot_count = count;
+
+    QRegion dirty;
+    int     dirty_rect_count = 0;
+    auto    add_dirty = [&dirty, &dirty_rect_count](const QRect &_rrect){
+        if(++dirty_rect_count <= max_dirty_rect_count){
+            dirty += _rrect;
+        }else{
+            //QRegion union gets expensive with many rects
+            dirty = dirty.boundingRect().united(_rrect);
+        }
+    };
+
+    next_frame_positions.clear();
+    for(size_t i = 0; i < plot_count; ++i){
+        const PlotEntry &rentry = plot_entries[i];
+        const QPoint    pt(rentry.x, rentry.y);
+        auto            it = frame_positions.find(rentry.rgb_color);
+
+        if(it == frame_positions.end()){
+            add_dirty(bubbleRect(pt.x(), pt.y(), Renderer::sprite_size));
+        }else{
+            if(it->second != pt){
+                add_dirty(bubbleRect(it->second.x(), it->second.y(), Renderer::sprite_size));
+                add_dirty(bubbleRect(pt.x(), pt.y(), Renderer::sprite_size));
+            }
+            frame_positions.erase(it);
+        }
+        next_frame_positions[rentry.rgb_color] = pt;
+    }
+    //what is left went away
+    for(const auto &rpos: frame_positions){
+        add_dirty(bubbleRect(rpos.second.x(), rpos.second.y(), Renderer::sprite_size));
+    }
+    swap(frame_positions, next_frame_positions);
+
+    const QPoint my_pos(viewport.x(pos.x()), viewport.y(pos.y()));
+
+    if(my_pos != frame_pos){
+        add_dirty(bubbleRect(frame_pos.x(), frame_pos.y(), Renderer::my_sprite_size));
+        add_dirty(bubbleRect(my_pos.x(), my_pos.y(), Renderer::my_sprite_size));
+        //the status line
+        const int status_height = fontMetrics().height() + 2;
+        add_dirty(QRect(0, height() - status_height, width(), status_height));
+        frame_pos = my_pos;
+    }
+
+    if(full_repaint){
+        full_repaint = false;
+        update();
+    }else if(!dirty.isEmpty()){
+        update(dirty);
+    }//else nothing moved - no repaint
 }
 
-void Widget::paintEvent(QPaintEvent *)
+void Widget::paintEvent(QPaintEvent *event)
 {
     QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing, antialiased);
     painter.translate(width()/2, height()/2);
 
-    painter.setRenderHint(QPainter::Antialiasing, antialiased);
+    //paint the snapshot taken by onFrame, clipped to the dirty area
+    renderer.drawPlot(painter, plot_entries.data(), plot_count, event->rect().translated(-(width()/2), -(height()/2)));
+
+    const uint32_t  my_rgb_color = engine_ptr->myRgbColor();
+    const long      x = viewport.x(pos.x());
+    const long      y = viewport.y(pos.y());
+
+    renderer.drawLocal(painter, x, y, my_rgb_color);
 
-    PlotIterator plotit = engine_ptr->plot();
+    if(status_text.text().isEmpty() or status_pos != pos or status_x != x or status_y != y){
+        //only lay out the status text again when it changes
+        QString         t;
+        QTextStream(&t)<<pos.x()<<':'<<pos.y()<<" "<<x<<':'<<y;
+        status_text.setText(t);
+        status_text.prepare(QTransform(), painter.font());
+        status_pos = pos;
+        status_x = x;
+        status_y = y;
+    }
     uint32_t        r;
     uint32_t        g;
     uint32_t        b;
-
-    while(!plotit.end()){
-        split_color(plotit.rgbColor(), r, g, b);
-        painter.setPen(QPen(QColor(r, g, b), 3));
-        painter.setBrush(QBrush(QColor(r, g, b)));
-        
-        //painter.drawEllipse(QRect(plotit.x() - 10, plotit.y() - 10, 20, 20));
-        painter.drawEllipse(QRect(engine_ptr->scaleX(plotit.x(), width()) - 10, engine_ptr->scaleY(plotit.y(), height()) - 10, 20, 20));
-        ++plotit;
-    }
-
-    split_color(plotit.myRgbColor(), r, g, b);
-    painter.setPen(QPen(QColor(r, g, b), 3));
-    painter.setBrush(QBrush(QColor(r, g, b)));
-    //painter.drawEllipse(QRect(pos.x() - 20, pos.y() - 20, 40, 40));
-    const long x = engine_ptr->scaleX(pos.x(), width());
-    const long y = engine_ptr->scaleY(pos.y(), height());
-    painter.drawEllipse(QRect(x - 20, y - 20, 40, 40));
-    QString         t;
-    QTextStream(&t)<<pos.x()<<':'<<pos.y()<<" "<<x<<':'<<y;
-    painter.drawText(QPoint(-(width()/2), height()/2), t);
+    split_color(my_rgb_color, r, g, b);
+    painter.setPen(QColor(r, g, b));
+    painter.drawStaticText(QPoint(-(width()/2), height()/2 - status_text.size().height()), status_text);
 }
 
 void Widget::mousePressEvent(QMouseEvent *event){
     if (event->button() == Qt::LeftButton) {
-        pos = event->pos();
-        pos = QPoint(engine_ptr->reverseScaleX(pos.x() - width()/2, width()), engine_ptr->reverseScaleY(pos.y() - height()/2, height()));
+        pos = viewportToCanvas(event->pos());
         moving = true;
-        update();
+        scheduleFrame();
     }else if((event->button() == Qt::RightButton)){
         engine_ptr->pause();
+    }else if((event->button() == Qt::MiddleButton)){
+        pan_pos = event->pos();
+        panning = true;
     }
 }
 
 void Widget::mouseMoveEvent(QMouseEvent *event){
     if ((event->buttons() & Qt::LeftButton) && moving){
-        pos = event->pos();
-        pos = QPoint(engine_ptr->reverseScaleX(pos.x() - width()/2, width()), engine_ptr->reverseScaleY(pos.y() - height()/2, height()));
+        pos = viewportToCanvas(event->pos());
         engine_ptr->moveEvent(pos.x(), pos.y());
-        update();
+        scheduleFrame();
+    }else if((event->buttons() & Qt::MiddleButton) && panning){
+        const QPoint delta = event->pos() - pan_pos;
+        pan_pos = event->pos();
+        viewport.pan(delta.x(), delta.y());
+        invalidateFrame();
     }
 }
 
 void Widget::mouseReleaseEvent(QMouseEvent *event){
     if ((event->button() == Qt::LeftButton) && moving) {
-        pos = event->pos();
-        pos = QPoint(engine_ptr->reverseScaleX(pos.x() - width()/2, width()), engine_ptr->reverseScaleY(pos.y() - height()/2, height()));
+        pos = viewportToCanvas(event->pos());
         moving = false;
+        engine_ptr->moveEvent(pos.x(), pos.y(), true);
         if(engine_ptr->autoPilot()){
             autoMoveEvent();
         }else{
-            update();
+            scheduleFrame();
         }
     }else if((event->button() == Qt::RightButton)){
         engine_ptr->resume();
+    }else if((event->button() == Qt::MiddleButton)){
+        panning = false;
     }
 }
 
+void Widget::wheelEvent(QWheelEvent *event){
+    const int32_t   min_zoom = Viewport::fixed_one;
+    const int32_t   max_zoom = 64 * Viewport::fixed_one;
+    const QPoint    anchor = viewportToCanvas(event->pos());
+    int32_t         zoom = viewport.zoom();
+
+    if(event->angleDelta().y() > 0){
+        zoom = std::min(zoom + zoom/4, max_zoom);
+    }else if(event->angleDelta().y() < 0){
+        zoom = std::max(zoom - zoom/5, min_zoom);
+    }
+    viewport.zoom(zoom);
+    //keep the canvas point under the cursor in place
+    const QPoint moved = viewportToCanvas(event->pos());
+    viewport.center(viewport.centerX() + anchor.x() - moved.x(), viewport.centerY() + anchor.y() - moved.y());
+    if(zoom == min_zoom){
+        viewport.center(0, 0);
+    }
+    event->accept();
+    invalidateFrame();
+}
+
 void Widget::autoMoveEvent(){
     if(!moving){
         int x,y;
         engine_ptr->getAutoPosition(x, y);
         pos = QPoint(x, y);
         engine_ptr->moveEvent(pos.x(), pos.y());
-        update();
+        scheduleFrame();
     }
 }
 
 void Widget::resizeEvent(QResizeEvent *event){
     //QWidget::resizeEvent(event);
     //engine_ptr->setFrame(width(), height());
+    viewport.resize(width(), height());
+    invalidateFrame();
+}
+
+QPoint Widget::viewportToCanvas(const QPoint &_pos)const{
+    return QPoint(viewport.reverseX(_pos.x() - width()/2), viewport.reverseY(_pos.y() - height()/2));
 }
 
 }//namespace client
@@ -2,7 +2,12 @@
 #define BUBBLES_CLIENT_WIDGET_HPP
 
 #include <QWidget>
+#include <QStaticText>
+#include <QTimer>
+#include <vector>
+#include <unordered_map>
 #include "client/engine/bubbles_client_engine.hpp"
+#include "bubbles_client_renderer.hpp"
 
 
 namespace bubbles{
@@ -32,15 +37,41 @@ protected:
     void mousePressEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
     void mouseMoveEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
     void mouseReleaseEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
+    void wheelEvent(QWheelEvent *event) Q_DECL_OVERRIDE;
     void paintEvent(QPaintEvent *event) Q_DECL_OVERRIDE;
     void resizeEvent(QResizeEvent *event) Q_DECL_OVERRIDE;
 private slots:
     void autoMoveEvent();
+    void scheduleFrame();
+    void onFrame();
 private:
-    bool                antialiased;
+    void invalidateFrame();
+    QPoint viewportToCanvas(const QPoint &_pos)const;
+    QRect bubbleRect(const int _x, const int _y, const int _size)const;
+private:
+    using PlotEntryVectorT = std::vector<PlotEntry>;
+    using PositionMapT = std::unordered_map<uint32_t, QPoint>;
+
+    static const int    max_dirty_rect_count = 64;//above this, repaint the bounding rectangle
+
     QPoint              pos;
     bool                moving;
+    bool                panning;
+    QPoint              pan_pos;
     Engine::PointerT    &engine_ptr;
+    Viewport            viewport;
+    PlotEntryVectorT    plot_entries;
+    size_t              plot_count;//entries of the frame being shown
+    PositionMapT        frame_positions;//rgb_color -> viewport position, as last painted
+    PositionMapT        next_frame_positions;
+    QTimer              frame_timer;//coalesces the updates to the display refresh rate
+    bool                full_repaint;
+    QPoint              frame_pos;//local bubble position, as last painted
+    Renderer            renderer;
+    QStaticText         status_text;
+    QPoint              status_pos;
+    long                status_x;
+    long                status_y;
 };
 
 }//namespace client
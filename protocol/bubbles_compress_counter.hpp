@@ -0,0 +1,37 @@
+#ifndef BUBBLES_COMPRESS_COUNTER_HPP
+#define BUBBLES_COMPRESS_COUNTER_HPP
+
+#include "solid/frame/mpipc/mpipcconfiguration.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace bubbles{
+
+//outgoing payload, counted by the mpipc writer on any of its threads
+struct ByteCounters{
+    ByteCounters():raw_byte_count(0), compressed_byte_count(0){}
+
+    std::atomic<uint64_t>   raw_byte_count;//before compression
+    std::atomic<uint64_t>   compressed_byte_count;//what goes on the wire - raw if not compressible
+};
+
+//Wraps the writer compression of _rcfg so that every outgoing packet is counted in _rcounters.
+//Call it after the compression setup (e.g. frame::mpipc::snappy::setup) - without one
+//the packets are only counted. _rcounters must outlive the mpipc service.
+inline void count_sent_bytes(solid::frame::mpipc::Configuration &_rcfg, ByteCounters &_rcounters){
+    auto            compress_fnc = _rcfg.writer.inplace_compress_fnc;
+    ByteCounters    *pcounters = &_rcounters;
+
+    _rcfg.writer.inplace_compress_fnc = [compress_fnc, pcounters](char *_pdata, size_t _len, solid::ErrorConditionT &_rerror) mutable -> size_t{
+        const size_t rv = compress_fnc ? compress_fnc(_pdata, _len, _rerror) : 0;
+
+        pcounters->raw_byte_count.fetch_add(_len, std::memory_order_relaxed);
+        pcounters->compressed_byte_count.fetch_add(rv ? rv : _len, std::memory_order_relaxed);
+        return rv;
+    };
+}
+
+}//namespace bubbles
+
+#endif
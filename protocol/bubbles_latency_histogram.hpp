@@ -0,0 +1,125 @@
+#ifndef BUBBLES_LATENCY_HISTOGRAM_HPP
+#define BUBBLES_LATENCY_HISTOGRAM_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace bubbles{
+
+//Log-linear histogram of latency samples (microseconds).
+//Values below sub_bucket_count are kept exactly, above that every power of two
+//is split into sub_bucket_count buckets, so a reported percentile is at most
+//1/sub_bucket_count (~3%) above the real one. Recording is O(1) and allocation free.
+class LatencyHistogram{
+public:
+    static constexpr size_t sub_bucket_bits = 5;
+    static constexpr size_t sub_bucket_count = 1 << sub_bucket_bits;
+    static constexpr size_t bucket_count = sub_bucket_count + (64 - sub_bucket_bits) * sub_bucket_count;
+
+    LatencyHistogram(): counts(bucket_count, 0), total_count(0), total_sum(0), max_value(0){}
+
+    void record(const uint64_t _value){
+        ++counts[index(_value)];
+        ++total_count;
+        total_sum += _value;
+        if(_value > max_value){
+            max_value = _value;
+        }
+    }
+
+    void merge(const LatencyHistogram &_rother){
+        for(size_t i = 0; i < counts.size(); ++i){
+            counts[i] += _rother.counts[i];
+        }
+        total_count += _rother.total_count;
+        total_sum += _rother.total_sum;
+        if(_rother.max_value > max_value){
+            max_value = _rother.max_value;
+        }
+    }
+
+    void clear(){
+        counts.assign(counts.size(), 0);
+        total_count = 0;
+        total_sum = 0;
+        max_value = 0;
+    }
+
+    uint64_t count()const{
+        return total_count;
+    }
+
+    uint64_t max()const{
+        return max_value;
+    }
+
+    uint64_t mean()const{
+        return total_count ? total_sum / total_count : 0;
+    }
+
+    //e.g. 50 for the median, 99.9 for p999 - returns the upper bound of the bucket holding the percentile
+    uint64_t percentile(const double _percent)const{
+        if(total_count == 0){
+            return 0;
+        }
+        uint64_t    rank = static_cast<uint64_t>((_percent * total_count) / 100.0 + 0.5);
+        uint64_t    crt_count = 0;
+
+        if(rank == 0){
+            rank = 1;
+        }
+
+        for(size_t i = 0; i < counts.size(); ++i){
+            crt_count += counts[i];
+            if(crt_count >= rank){
+                const uint64_t value = upperBound(i);
+                return value < max_value ? value : max_value;
+            }
+        }
+        return max_value;
+    }
+private:
+    static size_t mostSignificantBit(const uint64_t _value){
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(_value);
+#else
+        size_t  msb = 0;
+        uint64_t value = _value;
+        while(value >>= 1){
+            ++msb;
+        }
+        return msb;
+#endif
+    }
+
+    static size_t index(const uint64_t _value){
+        if(_value < sub_bucket_count){
+            return static_cast<size_t>(_value);
+        }
+        const size_t shift = mostSignificantBit(_value) - sub_bucket_bits;
+        //(_value >> shift) is within [sub_bucket_count, 2 * sub_bucket_count)
+        return sub_bucket_count + shift * sub_bucket_count + static_cast<size_t>((_value >> shift) - sub_bucket_count);
+    }
+
+    static uint64_t upperBound(const size_t _index){
+        if(_index < sub_bucket_count){
+            return _index;
+        }
+        const size_t    shift = (_index - sub_bucket_count) / sub_bucket_count;
+        const uint64_t  sub = (_index - sub_bucket_count) % sub_bucket_count;
+        const uint64_t  lower = (sub_bucket_count + sub) << shift;
+        return lower + ((static_cast<uint64_t>(1) << shift) - 1);
+    }
+private:
+    using CountVectorT = std::vector<uint64_t>;
+
+    CountVectorT    counts;
+    uint64_t        total_count;
+    uint64_t        total_sum;
+    uint64_t        max_value;
+};
+
+}//namespace bubbles
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef BUBBLES_LOG_HPP
+#define BUBBLES_LOG_HPP
+
+#include "solid/system/log.hpp"
+
+#include <cstddef>
+
+//Compile time gated logging.
+//solid_log filters at run time - the level check is still paid on every call and,
+//on the fan-out path, on every recipient. bubbles_log compiles to nothing for the
+//levels above BUBBLES_LOG_MAX_LEVEL (Warning for release builds, Verbose otherwise).
+
+#define BUBBLES_LOG_LEVEL_Error     1
+#define BUBBLES_LOG_LEVEL_Warning   2
+#define BUBBLES_LOG_LEVEL_Info      3
+#define BUBBLES_LOG_LEVEL_Verbose   4
+
+#ifndef BUBBLES_LOG_MAX_LEVEL
+#ifdef NDEBUG
+#define BUBBLES_LOG_MAX_LEVEL BUBBLES_LOG_LEVEL_Warning
+#else
+#define BUBBLES_LOG_MAX_LEVEL BUBBLES_LOG_LEVEL_Verbose
+#endif
+#endif
+
+#define bubbles_log(Lgr, Flg, Txt)\
+    do{\
+        if(BUBBLES_LOG_LEVEL_##Flg <= BUBBLES_LOG_MAX_LEVEL){\
+            solid_log(Lgr, Flg, Txt);\
+        }\
+    }while(false)
+
+//For per recipient and per event paths: only one call in Cnt (per thread) is logged,
+//with the number of the call, so the rate stays readable.
+#define bubbles_log_sampled(Lgr, Flg, Cnt, Txt)\
+    do{\
+        if(BUBBLES_LOG_LEVEL_##Flg <= BUBBLES_LOG_MAX_LEVEL){\
+            static thread_local size_t bubbles_log_call_count = 0;\
+            if((bubbles_log_call_count++ % (Cnt)) == 0){\
+                solid_log(Lgr, Flg, "[sample "<<bubbles_log_call_count<<"/"<<(Cnt)<<"] "<<Txt);\
+            }\
+        }\
+    }while(false)
+
+#endif
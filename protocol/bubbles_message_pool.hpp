@@ -0,0 +1,136 @@
+#ifndef BUBBLES_MESSAGE_POOL_HPP
+#define BUBBLES_MESSAGE_POOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace bubbles{
+
+//Recycles messages instead of freeing them.
+//When the last shared_ptr of a message created by a pool is gone, the message is
+//reset (T::reset - keeps the capacity of its containers, up to a limit) and handed out again by
+//create(); the shared_ptr control blocks are recycled the same way. Once warm, a
+//pool does not touch the heap. The messages can outlive the pool.
+//The free lists are per thread and shared by all the pools of the same MessagePool
+//type - no lock is taken: a message released on a thread is reused by the next
+//create() on that thread. On the single reactor thread of an engine that is the
+//thread that created it.
+//MaxFreeCount - messages (and control blocks) kept for reuse per thread, the rest
+//are freed. It is part of the type, so pools with different limits have their own lists.
+template <class T, size_t MaxFreeCount = 1024>
+class MessagePool{
+    struct Cache{
+        Cache():block_size(0){}
+
+        ~Cache(){
+            for(auto pmsg: free_messages){
+                delete pmsg;
+            }
+            for(auto pblock: free_blocks){
+                ::operator delete(pblock);
+            }
+            cacheDestroyed() = true;
+        }
+
+        std::vector<T*>     free_messages;
+        std::vector<void*>  free_blocks;
+        size_t              block_size;
+    };
+
+    //nullptr while the thread is being torn down - the messages released then are freed
+    static Cache* cache(){
+        static thread_local Cache c;
+        return cacheDestroyed() ? nullptr : &c;
+    }
+
+    static bool& cacheDestroyed(){
+        static thread_local bool destroyed = false;
+        return destroyed;
+    }
+
+    struct Recycler{
+        void operator()(T *_pmsg)const{
+            Cache *pcache = cache();
+
+            if(pcache != nullptr and pcache->free_messages.size() < MaxFreeCount){
+                try{
+                    _pmsg->reset();
+                    pcache->free_messages.push_back(_pmsg);
+                    return;
+                }catch(...){
+                }
+            }
+            delete _pmsg;
+        }
+    };
+
+    //for the control blocks - only single objects of one size are recycled
+    template <class U>
+    struct BlockAllocator{
+        using value_type = U;
+
+        BlockAllocator(){}
+
+        template <class V>
+        BlockAllocator(const BlockAllocator<V> &){}
+
+        U* allocate(const size_t _n){
+            Cache *pcache = _n == 1 ? cache() : nullptr;
+
+            if(pcache != nullptr){
+                if(pcache->block_size == 0){
+                    pcache->block_size = sizeof(U);
+                }
+                if(pcache->block_size == sizeof(U) and pcache->free_blocks.size()){
+                    void *pblock = pcache->free_blocks.back();
+                    pcache->free_blocks.pop_back();
+                    return static_cast<U*>(pblock);
+                }
+            }
+            return static_cast<U*>(::operator new(_n * sizeof(U)));
+        }
+
+        void deallocate(U *_p, const size_t _n){
+            Cache *pcache = _n == 1 ? cache() : nullptr;
+
+            if(pcache != nullptr and pcache->block_size == sizeof(U) and pcache->free_blocks.size() < MaxFreeCount){
+                try{
+                    pcache->free_blocks.push_back(_p);
+                    return;
+                }catch(...){
+                }
+            }
+            ::operator delete(_p);
+        }
+
+        //any instance can free what another one allocated
+        template <class V>
+        bool operator==(const BlockAllocator<V> &)const{
+            return true;
+        }
+
+        template <class V>
+        bool operator!=(const BlockAllocator<V> &)const{
+            return false;
+        }
+    };
+public:
+    std::shared_ptr<T> create(){
+        Cache   *pcache = cache();
+        T       *pmsg = nullptr;
+
+        if(pcache != nullptr and pcache->free_messages.size()){
+            pmsg = pcache->free_messages.back();
+            pcache->free_messages.pop_back();
+        }else{
+            pmsg = new T;
+        }
+        return std::shared_ptr<T>(pmsg, Recycler(), BlockAllocator<T>());
+    }
+};
+
+}//namespace bubbles
+
+#endif
@@ -5,8 +5,7 @@
 #include "solid/frame/mpipc/mpipccontext.hpp"
 #include "solid/frame/mpipc/mpipcprotocol_serialization_v2.hpp"
 
-#include <vector>
-#include <deque>
+#include "protocol/bubbles_small_vector.hpp"
 
 namespace bubbles{
 
@@ -81,6 +80,10 @@ struct Event{
         Sentinel
     };
 
+    enum Flags{
+        ProbeFlag = 1,//data holds the sender's steady clock time in microseconds - see LatencyHistogram
+    };
+
     Event(uint16_t _type = Unknown): type(_type), flags(0), x(0), y(0), data(0){}
 
     void clear(){
@@ -107,7 +110,7 @@ struct Event{
 };
 
 struct EventStub{
-    using EventVectorT = std::vector<Event>;
+    using EventVectorT = SmallVector<Event, 3>;//a move usually carries 0 to 3 extra samples
 
     Event           event;
     ConnectionId    connection_id;
@@ -137,30 +140,64 @@ struct EventStub{
     }
 };
 
+//trace_id of the last EventsNotification serialized on the calling thread - lets the
+//mpipc writer compression tell which message it compresses (the last one started in the packet)
+inline uint64_t& serializing_trace_id(){
+    static thread_local uint64_t trace_id = 0;
+    return trace_id;
+}
+
 //Push notification - no guarantee and no feedback for delivery
 struct EventsNotification: solid::frame::mpipc::Message{
 
-    using EventStubDequeT   = std::deque<EventStub>;
+    using EventStubVectorT  = SmallVector<EventStub, 1>;//more only for join snapshots
 
     EventStub           event_stub;
-    EventStubDequeT     event_stubs;
+    EventStubVectorT    event_stubs;
     bool                is_init;//not serialized - used on server
+    uint64_t            trace_id;//not serialized - used on server, 0 if not traced
+    uint64_t            trace_time_nsec;//not serialized - used on server, when it was received or built
 
     static size_t containerLimit(){
         return 1024;
     }
 
-    EventsNotification():is_init(false){}
+    //capacity a reset message keeps in its containers - a join snapshot grows
+    //event_stubs to the size of the room, that is not kept around in a pool
+    static size_t keptCapacity(){
+        return 64;
+    }
+
+    EventsNotification():is_init(false), trace_id(0), trace_time_nsec(0){}
 
     void clear(){
         event_stubs.clear();
         event_stub.clear();
     }
 
+    //ready to be sent again - keeps the capacity of the containers up to keptCapacity, see MessagePool
+    void reset(){
+        clear();
+        if(event_stubs.capacity() > keptCapacity()){
+            event_stubs.shrink_to_fit();
+        }
+        if(event_stub.events.capacity() > keptCapacity()){
+            event_stub.events.shrink_to_fit();
+        }
+        clearHeader();
+        clearStateFlags();
+        event_stub.sender_rgb_color = 0;
+        is_init = false;
+        trace_id = 0;
+        trace_time_nsec = 0;
+    }
+
     SOLID_PROTOCOL_V2(_s, _rthis, _rctx, _name){
         const size_t limit_container = _s.limits().container();
         const size_t limit_string = _s.limits().string();
         
+        serializing_trace_id() = _rthis.trace_id;//0 when deserializing - trace_id is not on the wire
+
         _s.limitContainer(1024, _name);
         _s.limitString(1024, _name);
         _s.add(_rthis.event_stub, _rctx, "event_stub").add(_rthis.event_stubs, _rctx, "event_stubs");
@@ -198,6 +235,19 @@ struct EventsNotificationResponse: solid::frame::mpipc::Message{
     }
 };
 
+//Client asks the server to stop (suspend == true) or restart (suspend == false)
+//streaming room updates, while keeping the connection and its registration alive.
+//On restart the server pushes the current state of the room.
+struct SuspendNotification: solid::frame::mpipc::Message{
+    bool            suspend;
+
+    SuspendNotification(bool _suspend = true):suspend(_suspend){}
+
+    SOLID_PROTOCOL_V2(_s, _rthis, _rctx, _name){
+        _s.add(_rthis.suspend, _rctx, "suspend");
+    }
+};
+
 using ProtocolT = solid::frame::mpipc::serialization_v2::Protocol<uint8_t>;
 
 template <class R>
@@ -210,6 +260,7 @@ inline void protocol_setup(R _r, ProtocolT& _rproto)
     _r(_rproto, solid::TypeToType<EventsNotification>(), 3);
     _r(_rproto, solid::TypeToType<EventsNotificationRequest>(), 4);
     _r(_rproto, solid::TypeToType<EventsNotificationResponse>(), 5);
+    _r(_rproto, solid::TypeToType<SuspendNotification>(), 6);
 }
 
 
@@ -0,0 +1,348 @@
+#ifndef BUBBLES_SMALL_VECTOR_HPP
+#define BUBBLES_SMALL_VECTOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace bubbles{
+
+//std::vector like container keeping up to N elements inline - no heap allocation
+//until the N+1th element. Past that it grows on the heap like a vector and keeps
+//the capacity on clear(), so a recycled message does not allocate again.
+//Has the container interface the solid serialization relies on (value_type,
+//allocator_type and the other std container typedefs, iterators, size, clear,
+//push_back and insert at end).
+template <class T, size_t N>
+class SmallVector{
+    static_assert(N > 0, "SmallVector needs an inline capacity");
+public:
+    using value_type = T;
+    using allocator_type = std::allocator<T>;//only for the container detection - the heap buffer comes from operator new
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using iterator = T*;
+    using const_iterator = const T*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    SmallVector():pdata(inlineData()), sz(0), cp(N){}
+
+    SmallVector(std::initializer_list<T> _init):SmallVector(){
+        reserve(_init.size());
+        for(const auto &rvalue: _init){
+            emplace_back(rvalue);
+        }
+    }
+
+    SmallVector(const SmallVector &_rother):SmallVector(){
+        reserve(_rother.sz);
+        for(const auto &rvalue: _rother){
+            emplace_back(rvalue);
+        }
+    }
+
+    SmallVector(SmallVector &&_rother) noexcept(std::is_nothrow_move_constructible<T>::value):SmallVector(){
+        doSteal(_rother);
+    }
+
+    ~SmallVector(){
+        clear();
+        doFree();
+    }
+
+    SmallVector& operator=(const SmallVector &_rother){
+        if(this != &_rother){
+            clear();
+            reserve(_rother.sz);
+            for(const auto &rvalue: _rother){
+                emplace_back(rvalue);
+            }
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector &&_rother) noexcept(std::is_nothrow_move_constructible<T>::value){
+        if(this != &_rother){
+            clear();
+            doSteal(_rother);
+        }
+        return *this;
+    }
+
+    iterator begin(){
+        return pdata;
+    }
+    iterator end(){
+        return pdata + sz;
+    }
+    const_iterator begin()const{
+        return pdata;
+    }
+    const_iterator end()const{
+        return pdata + sz;
+    }
+    const_iterator cbegin()const{
+        return pdata;
+    }
+    const_iterator cend()const{
+        return pdata + sz;
+    }
+    reverse_iterator rbegin(){
+        return reverse_iterator(end());
+    }
+    reverse_iterator rend(){
+        return reverse_iterator(begin());
+    }
+    const_reverse_iterator rbegin()const{
+        return const_reverse_iterator(end());
+    }
+    const_reverse_iterator rend()const{
+        return const_reverse_iterator(begin());
+    }
+
+    size_type size()const{
+        return sz;
+    }
+
+    bool empty()const{
+        return sz == 0;
+    }
+
+    size_type capacity()const{
+        return cp;
+    }
+
+    size_type max_size()const{
+        return std::numeric_limits<size_type>::max() / sizeof(T);
+    }
+
+    allocator_type get_allocator()const{
+        return allocator_type();
+    }
+
+    static constexpr size_type inlineCapacity(){
+        return N;
+    }
+
+    T* data(){
+        return pdata;
+    }
+    const T* data()const{
+        return pdata;
+    }
+
+    T& operator[](const size_type _idx){
+        return pdata[_idx];
+    }
+    const T& operator[](const size_type _idx)const{
+        return pdata[_idx];
+    }
+
+    T& front(){
+        return pdata[0];
+    }
+    const T& front()const{
+        return pdata[0];
+    }
+
+    T& back(){
+        return pdata[sz - 1];
+    }
+    const T& back()const{
+        return pdata[sz - 1];
+    }
+
+    void reserve(const size_type _cp){
+        if(_cp > cp){
+            T *pnew_data = static_cast<T*>(::operator new(_cp * sizeof(T)));
+
+            doMoveTo(pnew_data);
+            doFree();
+            pdata = pnew_data;
+            cp = _cp;
+        }
+    }
+
+    //frees the heap buffer not used by the elements - back to the inline storage if they fit
+    void shrink_to_fit(){
+        if(not isInline() and sz < cp){
+            const size_type new_cp = sz <= N ? N : sz;
+            T               *pnew_data = sz <= N ? inlineData() : static_cast<T*>(::operator new(new_cp * sizeof(T)));
+
+            doMoveTo(pnew_data);
+            ::operator delete(pdata);
+            pdata = pnew_data;
+            cp = new_cp;
+        }
+    }
+
+    //destroys the elements, keeps the capacity
+    void clear(){
+        for(size_type i = 0; i < sz; ++i){
+            pdata[i].~T();
+        }
+        sz = 0;
+    }
+
+    template <class ...Args>
+    T& emplace_back(Args&& ..._args){
+        if(sz == cp){
+            //the new element is built before the old ones move - _args can refer to one of them
+            const size_type new_cp = cp * 2;
+            T               *pnew_data = static_cast<T*>(::operator new(new_cp * sizeof(T)));
+
+            try{
+                new(pnew_data + sz) T(std::forward<Args>(_args)...);
+            }catch(...){
+                ::operator delete(pnew_data);
+                throw;
+            }
+            doMoveTo(pnew_data);
+            doFree();
+            pdata = pnew_data;
+            cp = new_cp;
+        }else{
+            new(pdata + sz) T(std::forward<Args>(_args)...);
+        }
+        return pdata[sz++];
+    }
+
+    void push_back(const T &_rvalue){
+        emplace_back(_rvalue);
+    }
+
+    void push_back(T &&_uvalue){
+        emplace_back(std::move(_uvalue));
+    }
+
+    void pop_back(){
+        pdata[--sz].~T();
+    }
+
+    template <class ...Args>
+    iterator emplace(const_iterator _pos, Args&& ..._args){
+        const size_type idx = _pos - cbegin();
+
+        emplace_back(std::forward<Args>(_args)...);
+        std::rotate(begin() + idx, end() - 1, end());
+        return begin() + idx;
+    }
+
+    iterator insert(const_iterator _pos, const T &_rvalue){
+        return emplace(_pos, _rvalue);
+    }
+
+    iterator insert(const_iterator _pos, T &&_uvalue){
+        return emplace(_pos, std::move(_uvalue));
+    }
+
+    iterator erase(const_iterator _pos){
+        return erase(_pos, _pos + 1);
+    }
+
+    iterator erase(const_iterator _first, const_iterator _last){
+        iterator first = begin() + (_first - cbegin());
+        iterator last = begin() + (_last - cbegin());
+
+        if(first != last){
+            iterator new_end = std::move(last, end(), first);
+
+            while(end() != new_end){
+                pop_back();
+            }
+        }
+        return first;
+    }
+
+    void resize(const size_type _sz){
+        reserve(_sz);
+        while(sz < _sz){
+            emplace_back();
+        }
+        while(sz > _sz){
+            pop_back();
+        }
+    }
+
+    void resize(const size_type _sz, const T &_rvalue){
+        reserve(_sz);
+        while(sz < _sz){
+            emplace_back(_rvalue);
+        }
+        while(sz > _sz){
+            pop_back();
+        }
+    }
+
+    bool operator==(const SmallVector &_rother)const{
+        return sz == _rother.sz and std::equal(begin(), end(), _rother.begin());
+    }
+
+    bool operator!=(const SmallVector &_rother)const{
+        return not (*this == _rother);
+    }
+private:
+    T* inlineData(){
+        return reinterpret_cast<T*>(inline_storage);
+    }
+
+    bool isInline()const{
+        return pdata == reinterpret_cast<const T*>(inline_storage);
+    }
+
+    //moves the elements to _pnew_data and destroys them here - the size is kept
+    void doMoveTo(T *_pnew_data){
+        for(size_type i = 0; i < sz; ++i){
+            new(_pnew_data + i) T(std::move_if_noexcept(pdata[i]));
+            pdata[i].~T();
+        }
+    }
+
+    void doFree(){
+        if(not isInline()){
+            ::operator delete(pdata);
+            pdata = inlineData();
+            cp = N;
+        }
+    }
+
+    //this is empty - takes the heap buffer of _rother, or moves its inline elements
+    void doSteal(SmallVector &_rother){
+        if(_rother.isInline()){
+            reserve(_rother.sz);
+            for(auto &rvalue: _rother){
+                new(pdata + sz) T(std::move(rvalue));
+                ++sz;
+            }
+            _rother.clear();
+        }else{
+            doFree();
+            pdata = _rother.pdata;
+            sz = _rother.sz;
+            cp = _rother.cp;
+            _rother.pdata = _rother.inlineData();
+            _rother.sz = 0;
+            _rother.cp = N;
+        }
+    }
+private:
+    T           *pdata;
+    size_type   sz;
+    size_type   cp;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type inline_storage[N];
+};
+
+}//namespace bubbles
+
+#endif
@@ -5,11 +5,16 @@
 #include <algorithm>
 #include <string>
 #include <unordered_set>
+#include <vector>
+#include <chrono>
 
 #include "bubbles_server_engine.hpp"
+#include "bubbles_server_metrics.hpp"
+#include "bubbles_server_trace.hpp"
+#include "protocol/bubbles_message_pool.hpp"
 #include "solid/frame/mpipc/mpipccontext.hpp"
 #include "solid/frame/mpipc/mpipcservice.hpp"
-#include "solid/system/log.hpp"
+#include "protocol/bubbles_log.hpp"
 #include "solid/system/cassert.hpp"
 #include "solid/utility/any.hpp"
 
@@ -34,48 +39,83 @@ const char * error_message(const uint32_t err_id){
     }
 }
 
-struct ConnectionData{
-    ConnectionData(): room_index(solid::InvalidIndex()), room_entry_index(solid::InvalidIndex()){}
+//the per recipient logs keep one line in log_sample_count - see bubbles_log_sampled
+const size_t log_sample_count = 1024;
 
-    bool registered()const{
-        return room_index != solid::InvalidIndex();
-    }
+//the events a message accounts for in the pending counts
+size_t message_event_count(const EventsNotification &_rmsg){
+    return 1 + _rmsg.event_stub.events.size() + _rmsg.event_stubs.size();
+}
 
-    void clear(){
-        room_index = -1;
-        room_entry_index = -1;
+//the spans of a message - see trace::dump
+const trace::SpanType fanout_span{"fanout", "room", "recipients", false};
+const trace::SpanType snapshot_span{"snapshot", "room", "event_stubs", false};
+const trace::SpanType deliver_span{"deliver", "room", "recipient", true};//queued to the recipient until the write completed
+
+//sends through the mpipc service the connections belong to
+class MpipcSender: public Sender{
+public:
+    MpipcSender():pservice(nullptr){}
+
+    void service(solid::frame::mpipc::Service &_rservice){
+        pservice = &_rservice;
     }
 
-    size_t      room_index;
-    size_t      room_entry_index;
+    solid::ErrorConditionT sendMessage(
+        ConnectionData &_rcon_data,
+        std::shared_ptr<EventsNotification> const &_rmsg_ptr
+    ) override{
+        return pservice->sendMessage(_rcon_data.recipient_id, _rmsg_ptr, {frame::mpipc::MessageFlagsE::Synchronous});
+    }
+private:
+    solid::frame::mpipc::Service    *pservice;
 };
 
-using ConnectionId = solid::frame::mpipc::RecipientId;
+using TraceSendQueueT = vector<std::pair<uint64_t, uint64_t>>;//trace id, enqueue time - only traced messages get in
 
 struct ConnectionStub{
 
     size_t                  pending_count;
     size_t                  dropped_message_count;
     size_t                  crt_fetch_pos;
-    ConnectionId            id;
+    size_t                  snapshot_stub_count;//event stubs sent so far by the running snapshot
+    ConnectionData          *pcon_data;//nullptr for a free slot
     Event                   last_event;
     std::string             last_text;
     uint32_t                rgb_color;
+    bool                    suspended;//the client does not want room updates for now
+    TraceSendQueueT         trace_sendq;//traced messages queued to the connection, in send order
 
     void clear(){
         pending_count = 0;
+        suspended = false;
         crt_fetch_pos = solid::InvalidIndex();
-        id.clear();
+        snapshot_stub_count = 0;
+        pcon_data = nullptr;
         last_text.clear();
         last_event.clear();
+        trace_sendq.clear();
+    }
+
+    //when the traced message was queued to this connection - 0 if it was not
+    uint64_t traceSent(const uint64_t _trace_id){
+        //the sends complete in order - it is the front one unless a trace was lost
+        for(auto it = trace_sendq.begin(); it != trace_sendq.end(); ++it){
+            if(it->first == _trace_id){
+                const uint64_t enqueue_nsec = it->second;
+                trace_sendq.erase(it);
+                return enqueue_nsec;
+            }
+        }
+        return 0;
     }
 
     bool canAcceptEventsNotification(const EngineConfiguration &_rconfig, const EventsNotification& /*_rmsg*/, const size_t _sender_index)const{
-        return id.isValidPool() and pending_count < _rconfig.connection_max_pending_count and crt_fetch_pos > _sender_index;
+        return pcon_data != nullptr and not suspended and pending_count < _rconfig.connection_max_pending_count and crt_fetch_pos > _sender_index;
     }
 
     bool canAcceptEventsNotification(const EngineConfiguration &_rconfig)const{
-        return id.isValidPool() and pending_count < _rconfig.connection_max_pending_count;
+        return pcon_data != nullptr and not suspended and pending_count < _rconfig.connection_max_pending_count;
     }
 
     void saveLastEvent(const EventsNotification& _rmsg){
@@ -103,7 +143,7 @@ struct ConnectionStub{
         return last_event.type != Event::Unknown;
     }
 
-    ConnectionStub():pending_count(0), dropped_message_count(0), crt_fetch_pos(solid::InvalidIndex{}){}
+    ConnectionStub():pending_count(0), dropped_message_count(0), crt_fetch_pos(solid::InvalidIndex{}), snapshot_stub_count(0), pcon_data(nullptr), suspended(false){}
 };
 
 using ConnectionVectorT = deque<ConnectionStub>;
@@ -112,7 +152,10 @@ using ColorSetT = unordered_set<uint32_t>;
 
 
 struct RoomStub{
-    RoomStub():crt_r_color(0), crt_g_color(0), crt_b_color(0), crt_rgb_color_step(255), crt_color_pos(0){}
+    RoomStub(
+    ):  crt_r_color(0), crt_g_color(0), crt_b_color(0), crt_rgb_color_step(255), crt_color_pos(0),
+        received_message_count(0), received_event_count(0), sent_message_count(0), sent_event_count(0),
+        dropped_message_count(0), stall_count(0), tick_handler_nsec(0){}
 
     string              name;
     ConnectionVectorT   connections;
@@ -126,15 +169,41 @@ struct RoomStub{
     uint32_t            crt_rgb_color_step;
     uint16_t            crt_color_pos;
 
+    //metrics - see Engine::writeMetrics
+    uint64_t            received_message_count;
+    uint64_t            received_event_count;
+    uint64_t            sent_message_count;
+    uint64_t            sent_event_count;
+    uint64_t            dropped_message_count;//not sent because the recipient had too many pending events
+    uint64_t            stall_count;//entry point calls over EngineConfiguration::stall_threshold_usec
+    uint64_t            tick_handler_nsec;//entry point time on the room - see Engine::takeHandlerTime
+
     bool empty()const{
         return connections.size() == free_stack.size();
     }
 
+    size_t memberCount()const{
+        return connections.size() - free_stack.size();
+    }
+
     void clear(){
         name.clear();
         while(free_stack.size()) free_stack.pop();
 
         connections.clear();
+
+        received_message_count = 0;
+        received_event_count = 0;
+        sent_message_count = 0;
+        sent_event_count = 0;
+        dropped_message_count = 0;
+        stall_count = 0;
+        tick_handler_nsec = 0;
+    }
+
+    void messageSent(const EventsNotification &_rmsg){
+        ++sent_message_count;
+        sent_event_count += message_event_count(_rmsg);
     }
 };
 
@@ -155,39 +224,257 @@ struct StringPtrEqual{
 
 using NameMapT = unordered_map<const string*, size_t, StringPtrHash, StringPtrEqual>;
 
+struct HandlerTotal{
+    const char  *name;
+    uint64_t    nsec;
+    size_t      call_count;
+};
+
+using HandlerTotalVectorT = vector<HandlerTotal>;
+using IndexVectorT = vector<size_t>;
+
 struct Engine::Data{
-    Data(const EngineConfiguration &_config):config(_config), max_dropped_message_count(0){}
+    Data(
+        const EngineConfiguration &_config
+    ):  config(_config), max_dropped_message_count(0), rsender(mpipc_sender),
+        connection_count(0), registration_failure_count(0), stall_count(0),
+        tick_handler_nsec(0), tick_call_count(0){}
+    Data(
+        const EngineConfiguration &_config, Sender &_rsender
+    ):  config(_config), max_dropped_message_count(0), rsender(_rsender),
+        connection_count(0), registration_failure_count(0), stall_count(0),
+        tick_handler_nsec(0), tick_call_count(0){}
 
     RoomVectorT             rooms;
     FreeStackT              free_stack;
     NameMapT                room_map;
     EngineConfiguration     config;
     size_t                  max_dropped_message_count;
+    MpipcSender             mpipc_sender;
+    Sender                  &rsender;
+    MessagePool<EventsNotification> message_pool;//for the received, snapshot and departure messages
+    std::string             room_name_buffer;//the lowercase room name of a registration
+
+    //metrics - see Engine::writeMetrics
+    size_t                  connection_count;
+    uint64_t                registration_failure_count;
+    MetricsSummary          fanout_duration_nsec;
+    MetricsSummary          pending_depth;//recipient pending events right after an enqueue
+    MetricsSummary          snapshot_size;//event stubs sent by a complete join (or resume) snapshot
+    MetricsSummary          handler_duration_nsec;
+    uint64_t                stall_count;
+
+    //see Engine::takeHandlerTime
+    uint64_t                tick_handler_nsec;
+    size_t                  tick_call_count;
+    HandlerTotalVectorT     handler_totals;//one per entry point name, kept between ticks
+    IndexVectorT            tick_rooms;//rooms with a non zero tick_handler_nsec
+
+    void handlerDone(const char *_name, const size_t _room_index, const uint64_t _duration_nsec);
+
+    class HandlerTimer;
+
+    Sender& sender(ConnectionData &_rcon_data){
+        return _rcon_data.psender ? *_rcon_data.psender : rsender;
+    }
+};
+
+void Engine::Data::handlerDone(const char *_name, const size_t _room_index, const uint64_t _duration_nsec){
+    handler_duration_nsec.record(_duration_nsec);
+
+    tick_handler_nsec += _duration_nsec;
+    ++tick_call_count;
+    {
+        auto it = std::find_if(
+            handler_totals.begin(), handler_totals.end(),
+            [_name](const HandlerTotal &_rht){return _rht.name == _name;}
+        );
+        if(it == handler_totals.end()){
+            handler_totals.push_back(HandlerTotal{_name, 0, 0});
+            it = handler_totals.end() - 1;
+        }
+        it->nsec += _duration_nsec;
+        ++it->call_count;
+    }
+    if(_room_index < rooms.size()){
+        RoomStub &room = rooms[_room_index];
+
+        if(room.tick_handler_nsec == 0){
+            tick_rooms.push_back(_room_index);
+        }
+        room.tick_handler_nsec += _duration_nsec;
+    }
+
+    if(config.stall_threshold_usec and _duration_nsec / 1000 >= config.stall_threshold_usec){
+        ++stall_count;
+        if(_room_index < rooms.size()){
+            RoomStub &room = rooms[_room_index];
+
+            ++room.stall_count;
+            bubbles_log(generic_logger, Warning, "stall: "<<_name<<" took "<<_duration_nsec / 1000<<"usec on room "<<room.name<<" with "<<room.memberCount()<<" members");
+        }else{
+            bubbles_log(generic_logger, Warning, "stall: "<<_name<<" took "<<_duration_nsec / 1000<<"usec");
+        }
+    }
+}
+
+//times an entry point call - the room is read at the end, registerConnection only knows it then
+class Engine::Data::HandlerTimer{
+public:
+    HandlerTimer(
+        Data &_rd, const char *_name, const ConnectionData &_rcon_data
+    ):  rd(_rd), name(_name), rcon_data(_rcon_data), room_index(_rcon_data.room_index),
+        start_time(std::chrono::steady_clock::now()){}
+
+    ~HandlerTimer(){
+        rd.handlerDone(
+            name, rcon_data.registered() ? rcon_data.room_index : room_index,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count()
+        );
+    }
+private:
+    Data                                            &rd;
+    const char                                      *name;
+    const ConnectionData                            &rcon_data;
+    const size_t                                    room_index;
+    const std::chrono::steady_clock::time_point     start_time;
 };
 
 Engine::Engine(const EngineConfiguration &_config):d(*(new Data(_config))){}
 
+Engine::Engine(const EngineConfiguration &_config, Sender &_rsender):d(*(new Data(_config, _rsender))){}
+
 Engine::~Engine(){
     delete &d;
 }
 
 void Engine::plotStatistics(std::ostream &_ros){
     _ros<<"Max per connection dropped messages: "<<d.max_dropped_message_count<<endl;
+    _ros<<"Stalls: "<<d.stall_count<<endl;
+}
+
+bool Engine::takeHandlerTime(HandlerTime &_rtime){
+    if(d.tick_call_count == 0){
+        return false;
+    }
+    _rtime.total_usec = d.tick_handler_nsec / 1000;
+    _rtime.call_count = d.tick_call_count;
+
+    _rtime.handler_name = nullptr;
+    _rtime.handler_usec = 0;
+    _rtime.handler_call_count = 0;
+    for(auto &rht: d.handler_totals){
+        if(rht.call_count and (_rtime.handler_name == nullptr or rht.nsec / 1000 > _rtime.handler_usec)){
+            _rtime.handler_name = rht.name;
+            _rtime.handler_usec = rht.nsec / 1000;
+            _rtime.handler_call_count = rht.call_count;
+        }
+        rht.nsec = 0;
+        rht.call_count = 0;
+    }
+
+    uint64_t room_nsec = 0;
+
+    _rtime.room_index = solid::InvalidIndex();
+    for(const auto room_index: d.tick_rooms){
+        if(room_index < d.rooms.size()){
+            RoomStub &room = d.rooms[room_index];
+
+            if(room.tick_handler_nsec > room_nsec){
+                room_nsec = room.tick_handler_nsec;
+                _rtime.room_index = room_index;
+            }
+            room.tick_handler_nsec = 0;
+        }
+    }
+    _rtime.room_usec = room_nsec / 1000;
+    if(_rtime.room_index < d.rooms.size()){
+        _rtime.room_name = d.rooms[_rtime.room_index].name;
+    }else{
+        _rtime.room_name.clear();
+    }
+
+    d.tick_rooms.clear();
+    d.tick_handler_nsec = 0;
+    d.tick_call_count = 0;
+    return true;
+}
+
+void Engine::writeMetrics(MetricsWriter &_rwriter){
+    struct RoomCounter{
+        const char  *name;
+        const char  *type;
+        const char  *help;
+        uint64_t    (*value)(const RoomStub &);
+    };
+    static const RoomCounter room_counters[] = {
+        {"bubbles_room_members", "gauge", "Members of the room",
+            [](const RoomStub &_rroom){return static_cast<uint64_t>(_rroom.memberCount());}},
+        {"bubbles_room_received_messages_total", "counter", "EventsNotification messages received from the members of the room",
+            [](const RoomStub &_rroom){return _rroom.received_message_count;}},
+        {"bubbles_room_received_events_total", "counter", "Event stubs received from the members of the room",
+            [](const RoomStub &_rroom){return _rroom.received_event_count;}},
+        {"bubbles_room_sent_messages_total", "counter", "EventsNotification messages sent to the members of the room",
+            [](const RoomStub &_rroom){return _rroom.sent_message_count;}},
+        {"bubbles_room_sent_events_total", "counter", "Event stubs sent to the members of the room",
+            [](const RoomStub &_rroom){return _rroom.sent_event_count;}},
+        {"bubbles_room_dropped_messages_total", "counter", "Messages not sent because the recipient had too many pending events",
+            [](const RoomStub &_rroom){return _rroom.dropped_message_count;}},
+        {"bubbles_room_stalls_total", "counter", "Engine calls on the room that blocked the reactor longer than the stall threshold",
+            [](const RoomStub &_rroom){return _rroom.stall_count;}},
+    };
+
+    for(const auto &rcounter: room_counters){
+        _rwriter.family(rcounter.name, rcounter.type, rcounter.help);
+        for(const auto &rroom: d.rooms){
+            if(not rroom.empty()){
+                _rwriter.sample(rcounter.name, MetricsWriter::label("room", rroom.name), rcounter.value(rroom));
+            }
+        }
+    }
+
+    _rwriter.family("bubbles_connections", "gauge", "Registered connections");
+    _rwriter.sample("bubbles_connections", "", d.connection_count);
+
+    _rwriter.family("bubbles_registration_failures_total", "counter", "Registrations refused");
+    _rwriter.sample("bubbles_registration_failures_total", "", d.registration_failure_count);
+
+    _rwriter.family("bubbles_fanout_duration_seconds", "summary", "Time to fan out one received message to its room");
+    _rwriter.summary("bubbles_fanout_duration_seconds", "", d.fanout_duration_nsec, 1e-9);
+
+    _rwriter.family("bubbles_pending_events", "summary", "Pending events of a recipient right after a message was queued to it");
+    _rwriter.summary("bubbles_pending_events", "", d.pending_depth);
+
+    _rwriter.family("bubbles_snapshot_event_stubs", "summary", "Event stubs sent by a complete join or resume snapshot");
+    _rwriter.summary("bubbles_snapshot_event_stubs", "", d.snapshot_size);
+
+    _rwriter.family("bubbles_handler_duration_seconds", "summary", "Duration of an engine call on the reactor thread");
+    _rwriter.summary("bubbles_handler_duration_seconds", "", d.handler_duration_nsec, 1e-9);
+
+    _rwriter.family("bubbles_stalls_total", "counter", "Engine calls that blocked the reactor longer than the stall threshold");
+    _rwriter.sample("bubbles_stalls_total", "", d.stall_count);
+
+    d.fanout_duration_nsec.clearWindow();
+    d.pending_depth.clearWindow();
+    d.snapshot_size.clearWindow();
+    d.handler_duration_nsec.clearWindow();
 }
 
 void Engine::onConnectionStart(solid::frame::mpipc::ConnectionContext &_rctx){
-    solid_log(generic_logger, Info, _rctx.recipientId());
+    bubbles_log(generic_logger, Info, _rctx.recipientId());
 
     _rctx.any() = solid::make_any<0, ConnectionData>();
+    _rctx.any().cast<ConnectionData>()->recipient_id = _rctx.recipientId();
+    d.mpipc_sender.service(_rctx.service());
 }
 
 void Engine::onConnectionStop(solid::frame::mpipc::ConnectionContext &_rctx){
-    solid_log(generic_logger, Info, _rctx.recipientId()<<' '<<_rctx.error().message());
+    bubbles_log(generic_logger, Info, _rctx.recipientId()<<' '<<_rctx.error().message());
 
     ConnectionData *pcon_data = _rctx.any().cast<ConnectionData>();
 
     if(pcon_data and pcon_data->registered()){
-        unregisterConnection(_rctx, *pcon_data);
+        unregisterConnection(*pcon_data);
     }
 }
 
@@ -197,7 +484,7 @@ void Engine::onMessage(
     std::shared_ptr<RegisterRequest> &_rrecv_msg_ptr,
     solid::ErrorConditionT const &_rerror
 ){
-    solid_log(generic_logger, Info, _rctx.recipientId()<<" error: "<<_rerror.message());
+    bubbles_log(generic_logger, Info, _rctx.recipientId()<<" error: "<<_rerror.message());
     SOLID_ASSERT(_rrecv_msg_ptr);
     SOLID_ASSERT(not _rsent_msg_ptr);
     ConnectionData &rcon_data = *_rctx.any().cast<ConnectionData>();
@@ -207,7 +494,8 @@ void Engine::onMessage(
 
     if(not rcon_data.registered()){
         uint32_t    rgb_color;
-        error_id = registerConnection(_rctx, rcon_data, *_rrecv_msg_ptr, rgb_color);
+        bubbles_log(generic_logger, Info, _rctx.recipientId()<<" room name "<<_rrecv_msg_ptr->room_name);
+        error_id = registerConnection(rcon_data, *_rrecv_msg_ptr, rgb_color);
 
         if(error_id == 0){
             
@@ -234,11 +522,11 @@ void Engine::onMessage(
     std::shared_ptr<RegisterResponse> &_rrecv_msg_ptr,
     solid::ErrorConditionT const &_rerror
 ){
-    solid_log(generic_logger, Info, _rctx.recipientId()<<" error: "<<_rerror.message());
+    bubbles_log(generic_logger, Info, _rctx.recipientId()<<" error: "<<_rerror.message());
     SOLID_ASSERT(not _rrecv_msg_ptr);
     SOLID_ASSERT(_rsent_msg_ptr);
     if(_rrecv_msg_ptr){
-        solid_log(generic_logger, Info, _rctx.recipientId()<<"closing connection");
+        bubbles_log(generic_logger, Info, _rctx.recipientId()<<"closing connection");
         _rctx.service().closeConnection(_rctx.recipientId());
     }
 }
@@ -249,7 +537,7 @@ void Engine::onMessage(
     std::shared_ptr<EventsNotification> &_rrecv_msg_ptr,
     solid::ErrorConditionT const &_rerror
 ){
-    solid_log(generic_logger, Info, _rctx.recipientId()<<" error: "<<_rerror.message());
+    bubbles_log_sampled(generic_logger, Info, log_sample_count, _rctx.recipientId()<<" error: "<<_rerror.message());
 
     if(_rrecv_msg_ptr){
         //received message
@@ -257,64 +545,116 @@ void Engine::onMessage(
         ConnectionData &rcon_data = *_rctx.any().cast<ConnectionData>();
 
         if(rcon_data.registered()){
-            RoomStub    &room = d.rooms[rcon_data.room_index];
-
-
-            ConnectionStub      &rcon_sender = room.connections[rcon_data.room_entry_index];
-
-            rcon_sender.saveLastEvent(*_rrecv_msg_ptr);
-            //TODO: set:
-            //_rrecv_msg_ptr->connection_id
-            _rrecv_msg_ptr->clearHeader(); // cumbersome - for now!
-            _rrecv_msg_ptr->event_stub.sender_rgb_color = rcon_sender.rgb_color;
-
-            for(size_t i = 0; i < room.connections.size(); ++i){
-
-                ConnectionStub &rcon = room.connections[i];
-
-                if(i != rcon_data.room_entry_index and rcon.canAcceptEventsNotification(d.config, *_rrecv_msg_ptr, rcon_data.room_entry_index)){
-                    rcon.pending_count += (1 + _rrecv_msg_ptr->event_stub.events.size());
-                    rcon.pending_count += _rrecv_msg_ptr->event_stubs.size();
-                    _rrecv_msg_ptr->clearStateFlags();
-                    solid_log(generic_logger, Info, i<<" pend_cnt = "<<rcon.pending_count<<" eventsz = "<<_rrecv_msg_ptr->event_stub.events.size());
-                    solid::ErrorConditionT err = _rctx.service().sendMessage(rcon.id, _rrecv_msg_ptr, {frame::mpipc::MessageFlagsE::Synchronous});
-                    if(err){
-                        solid_log(generic_logger, Warning, rcon_data.room_entry_index<<" failed send message: "<<err.message());
-                        rcon.pending_count -= (1 + _rrecv_msg_ptr->event_stub.events.size());
-                        rcon.pending_count -= _rrecv_msg_ptr->event_stubs.size();
-                    }
-                }else if(i != rcon_data.room_entry_index){
-                    solid_log(generic_logger, Info, _rctx.recipientId()<<" not sent to "<<i<<" pending count = "<<rcon.pending_count);
-                }
-            }
+            eventsReceived(rcon_data, _rrecv_msg_ptr);
         }else{
             _rctx.service().closeConnection(_rctx.recipientId());
         }
     }else if(_rsent_msg_ptr){
-        solid_log(generic_logger, Info, _rctx.recipientId()<<" error: "<<_rerror.message());
+        eventsSent(*_rctx.any().cast<ConnectionData>(), _rsent_msg_ptr);
+    }
+}
+
+std::shared_ptr<EventsNotification> Engine::createEventsNotification(){
+    return d.message_pool.create();
+}
+
+void Engine::eventsReceived(ConnectionData &_rcon_data, std::shared_ptr<EventsNotification> &_rmsg_ptr){
+    Data::HandlerTimer  handler_timer(d, "eventsReceived", _rcon_data);
+    const auto          start_time = std::chrono::steady_clock::now();
+    RoomStub            &room = d.rooms[_rcon_data.room_index];
+    ConnectionStub      &rcon_sender = room.connections[_rcon_data.room_entry_index];
+
+    size_t              recipient_count = 0;
+
+    ++room.received_message_count;
+    room.received_event_count += message_event_count(*_rmsg_ptr);
+
+    _rmsg_ptr->trace_id = trace::nextId();
+    if(_rmsg_ptr->trace_id){
+        _rmsg_ptr->trace_time_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(start_time.time_since_epoch()).count();
+    }
+
+    rcon_sender.saveLastEvent(*_rmsg_ptr);
+    //TODO: set:
+    //_rmsg_ptr->connection_id
+    _rmsg_ptr->clearHeader(); // cumbersome - for now!
+    _rmsg_ptr->event_stub.sender_rgb_color = rcon_sender.rgb_color;
+
+    for(size_t i = 0; i < room.connections.size(); ++i){
+
+        ConnectionStub &rcon = room.connections[i];
+
+        if(i != _rcon_data.room_entry_index and rcon.canAcceptEventsNotification(d.config, *_rmsg_ptr, _rcon_data.room_entry_index)){
+            rcon.pending_count += (1 + _rmsg_ptr->event_stub.events.size());
+            rcon.pending_count += _rmsg_ptr->event_stubs.size();
+            _rmsg_ptr->clearStateFlags();
+            bubbles_log_sampled(generic_logger, Info, log_sample_count, i<<" pend_cnt = "<<rcon.pending_count<<" eventsz = "<<_rmsg_ptr->event_stub.events.size());
+            const uint64_t          enqueue_nsec = _rmsg_ptr->trace_id ? trace::now() : 0;
+            solid::ErrorConditionT  err = d.sender(*rcon.pcon_data).sendMessage(*rcon.pcon_data, _rmsg_ptr);
+            if(err){
+                bubbles_log(generic_logger, Warning, _rcon_data.room_entry_index<<" failed send message: "<<err.message());
+                rcon.pending_count -= (1 + _rmsg_ptr->event_stub.events.size());
+                rcon.pending_count -= _rmsg_ptr->event_stubs.size();
+            }else{
+                if(enqueue_nsec){
+                    rcon.trace_sendq.emplace_back(_rmsg_ptr->trace_id, enqueue_nsec);
+                }
+                room.messageSent(*_rmsg_ptr);
+                d.pending_depth.record(rcon.pending_count);
+                ++recipient_count;
+            }
+        }else if(i != _rcon_data.room_entry_index){
+            bubbles_log_sampled(generic_logger, Info, log_sample_count, _rcon_data.room_entry_index<<" not sent to "<<i<<" pending count = "<<rcon.pending_count);
+            if(rcon.pcon_data != nullptr and not rcon.suspended and rcon.pending_count >= d.config.connection_max_pending_count){
+                ++rcon.dropped_message_count;
+                ++room.dropped_message_count;
+            }
+        }
+    }
+    const auto end_time = std::chrono::steady_clock::now();
+
+    d.fanout_duration_nsec.record(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count());
 
-        ConnectionData      &rcon_data = *_rctx.any().cast<ConnectionData>();
-        RoomStub            &room = d.rooms[rcon_data.room_index];
-        ConnectionStub      &rcon = room.connections[rcon_data.room_entry_index];
+    if(_rmsg_ptr->trace_id){
+        trace::record(
+            fanout_span, _rmsg_ptr->trace_time_nsec,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end_time.time_since_epoch()).count(),
+            _rmsg_ptr->trace_id, _rcon_data.room_index, recipient_count
+        );
+    }
+}
+
+void Engine::eventsSent(ConnectionData &_rcon_data, std::shared_ptr<EventsNotification> &_rmsg_ptr){
+    Data::HandlerTimer  handler_timer(d, "eventsSent", _rcon_data);
+    RoomStub            &room = d.rooms[_rcon_data.room_index];
+    ConnectionStub      &rcon = room.connections[_rcon_data.room_entry_index];
+
+    rcon.pending_count -= (1 + _rmsg_ptr->event_stub.events.size());
+    rcon.pending_count -= _rmsg_ptr->event_stubs.size();
 
+    bubbles_log_sampled(generic_logger, Info, log_sample_count, _rcon_data.room_entry_index<<" pend_cnt = "<<rcon.pending_count<<" eventsz = "<<_rmsg_ptr->event_stub.events.size());
 
-        rcon.pending_count -= (1 + _rsent_msg_ptr->event_stub.events.size());
-        rcon.pending_count -= _rsent_msg_ptr->event_stubs.size();
-        
-        solid_log(generic_logger, Info, rcon_data.room_entry_index<<" pend_cnt = "<<rcon.pending_count<<" eventsz = "<<_rsent_msg_ptr->event_stub.events.size());
+    if(_rmsg_ptr->trace_id){
+        const uint64_t enqueue_nsec = rcon.traceSent(_rmsg_ptr->trace_id);
 
-        if(rcon.crt_fetch_pos < room.connections.size()){
-            fetchLastEvents(_rctx, rcon_data, std::make_shared<EventsNotification>());
+        if(enqueue_nsec){
+            trace::record(deliver_span, enqueue_nsec, trace::now(), _rmsg_ptr->trace_id, _rcon_data.room_index, _rcon_data.room_entry_index);
         }
     }
+
+    if(rcon.crt_fetch_pos < room.connections.size() and not rcon.suspended){
+        fetchLastEvents(_rcon_data, d.message_pool.create());
+    }
 }
 
 void Engine::fetchLastEvents(
-    solid::frame::mpipc::ConnectionContext &_rctx, ConnectionData &_rcon_data,
+    ConnectionData &_rcon_data,
     std::shared_ptr<EventsNotification> &&_msg_ptr
 ){
     RoomStub            &room = d.rooms[_rcon_data.room_index];
     ConnectionStub      &rcrtcon = room.connections[_rcon_data.room_entry_index];
+    const uint64_t      trace_id = trace::nextId();
+    const uint64_t      start_nsec = trace_id ? trace::now() : 0;
 
     _msg_ptr->is_init = true;
     _msg_ptr->event_stubs.clear();
@@ -332,6 +672,7 @@ void Engine::fetchLastEvents(
             EventStub &back_event = _msg_ptr->event_stub.empty() ?  _msg_ptr->event_stub : _msg_ptr->event_stubs.back();
 
             back_event.event = rcon.last_event;
+            back_event.event.flags &= ~Event::ProbeFlag;//not a fresh move - keep it out of latency measurements
             back_event.text = rcon.last_text;
             back_event.sender_rgb_color = rcon.rgb_color;
             //back_event.connection_id = rcon.id;//TODO:
@@ -351,16 +692,33 @@ void Engine::fetchLastEvents(
 //      }
         rcrtcon.crt_fetch_pos = solid::InvalidIndex{};
     }
+    const bool snapshot_done = rcrtcon.crt_fetch_pos == solid::InvalidIndex{};
+
     if(_msg_ptr->event_stubs.size() or not _msg_ptr->event_stub.empty()){
         rcrtcon.pending_count += _msg_ptr->event_stubs.size();
         rcrtcon.pending_count += (1 + _msg_ptr->event_stub.events.size());
-        solid::ErrorConditionT  err =_rctx.service().sendMessage(rcrtcon.id, _msg_ptr, {frame::mpipc::MessageFlagsE::Synchronous});
+        if(trace_id){
+            _msg_ptr->trace_id = trace_id;
+            _msg_ptr->trace_time_nsec = trace::now();
+            trace::record(snapshot_span, start_nsec, _msg_ptr->trace_time_nsec, trace_id, _rcon_data.room_index, _msg_ptr->event_stubs.size() + 1);
+        }
+        solid::ErrorConditionT  err = d.sender(_rcon_data).sendMessage(_rcon_data, _msg_ptr);
         if(err){
-            solid_log(generic_logger, Warning, _rcon_data.room_entry_index<<" failed send message: "<<err.message());
+            bubbles_log(generic_logger, Warning, _rcon_data.room_entry_index<<" failed send message: "<<err.message());
             rcrtcon.pending_count -= _msg_ptr->event_stubs.size();
             rcrtcon.pending_count -= (1 + _msg_ptr->event_stub.events.size());
+        }else{
+            if(trace_id){
+                rcrtcon.trace_sendq.emplace_back(trace_id, _msg_ptr->trace_time_nsec);
+            }
+            room.messageSent(*_msg_ptr);
+            rcrtcon.snapshot_stub_count += _msg_ptr->event_stubs.size() + 1;
         }
     }
+    if(snapshot_done){
+        d.snapshot_size.record(rcrtcon.snapshot_stub_count);
+        rcrtcon.snapshot_stub_count = 0;
+    }
 }
 
 void Engine::onMessage(
@@ -369,8 +727,30 @@ void Engine::onMessage(
     std::shared_ptr<EventsNotificationRequest> &_rrecv_msg_ptr,
     solid::ErrorConditionT const &_rerror
 ){
-    solid_log(generic_logger, Info, _rctx.recipientId()<<" error: "<<_rerror.message());
-    //TODO:
+    bubbles_log_sampled(generic_logger, Info, log_sample_count, _rctx.recipientId()<<" error: "<<_rerror.message());
+
+    if(_rrecv_msg_ptr){
+        //an EventsNotification the client wants acknowledged - it times its send round trip on it
+        ConnectionData &rcon_data = *_rctx.any().cast<ConnectionData>();
+
+        if(rcon_data.registered()){
+            auto res_ptr = std::make_shared<EventsNotificationResponse>(*_rrecv_msg_ptr, 0, message_event_count(*_rrecv_msg_ptr), 0);
+            //the room gets a plain EventsNotification - the clients expect no request
+            std::shared_ptr<EventsNotification> msg_ptr = createEventsNotification();
+
+            msg_ptr->event_stub = std::move(_rrecv_msg_ptr->event_stub);
+            msg_ptr->event_stubs = std::move(_rrecv_msg_ptr->event_stubs);
+
+            eventsReceived(rcon_data, msg_ptr);
+
+            solid::ErrorConditionT err = _rctx.service().sendResponse(_rctx.recipientId(), res_ptr, {frame::mpipc::MessageFlagsE::Synchronous});
+            if(err){
+                bubbles_log(generic_logger, Warning, rcon_data.room_entry_index<<" failed send response: "<<err.message());
+            }
+        }else{
+            _rctx.service().closeConnection(_rctx.recipientId());
+        }
+    }
 }
 
 void Engine::onMessage(
@@ -379,25 +759,57 @@ void Engine::onMessage(
     std::shared_ptr<EventsNotificationResponse> &_rrecv_msg_ptr,
     solid::ErrorConditionT const &_rerror
 ){
-    solid_log(generic_logger, Info, _rctx.recipientId()<<" error: "<<_rerror.message());
-    //TODO:
+    bubbles_log_sampled(generic_logger, Info, log_sample_count, _rctx.recipientId()<<" error: "<<_rerror.message());
 }
 
-uint32_t Engine::registerConnection(
+void Engine::onMessage(
     solid::frame::mpipc::ConnectionContext &_rctx,
+    std::shared_ptr<SuspendNotification> &_rsent_msg_ptr,
+    std::shared_ptr<SuspendNotification> &_rrecv_msg_ptr,
+    solid::ErrorConditionT const &_rerror
+){
+    bubbles_log(generic_logger, Info, _rctx.recipientId()<<" error: "<<_rerror.message());
+
+    if(_rrecv_msg_ptr){
+        ConnectionData &rcon_data = *_rctx.any().cast<ConnectionData>();
+
+        if(rcon_data.registered()){
+            suspendConnection(rcon_data, _rrecv_msg_ptr->suspend);
+        }else{
+            _rctx.service().closeConnection(_rctx.recipientId());
+        }
+    }
+}
+
+void Engine::suspendConnection(ConnectionData &_rcon_data, const bool _suspend){
+    Data::HandlerTimer  handler_timer(d, "suspendConnection", _rcon_data);
+    RoomStub            &room = d.rooms[_rcon_data.room_index];
+    ConnectionStub      &rcon = room.connections[_rcon_data.room_entry_index];
+
+    bubbles_log(generic_logger, Info, _rcon_data.room_entry_index<<" suspend = "<<_suspend);
+
+    if(_suspend){
+        rcon.suspended = true;
+    }else if(rcon.suspended){
+        //push only the current state of the room
+        rcon.suspended = false;
+        rcon.crt_fetch_pos = 0;
+        fetchLastEvents(_rcon_data, d.message_pool.create());
+    }
+}
+
+uint32_t Engine::registerConnection(
     ConnectionData &_rcon_data,
     const RegisterRequest &_rreq,
     uint32_t &_rrgb_color
 ){
-
-    solid_log(generic_logger, Info, _rctx.recipientId()<<" room name "<<_rreq.room_name);
-
-    std::string room_name;
+    Data::HandlerTimer handler_timer(d, "registerConnection", _rcon_data);
+    std::string     &room_name = d.room_name_buffer;//reused - no allocation for a known room
 
     uint32_t    rgb_color = 0;
 
-    room_name.resize(_rreq.room_name.size());
-    std::transform(_rreq.room_name.begin(), _rreq.room_name.end(), room_name.begin(), ::tolower);
+    room_name.assign(_rreq.room_name);
+    std::transform(room_name.begin(), room_name.end(), room_name.begin(), ::tolower);
 
     {
         auto it = d.room_map.find(&room_name);
@@ -412,7 +824,7 @@ uint32_t Engine::registerConnection(
                 _rcon_data.room_index = d.rooms.size();
                 d.rooms.push_back(RoomStub{});
             }
-            d.rooms[_rcon_data.room_index].name = std::move(room_name);
+            d.rooms[_rcon_data.room_index].name = room_name;
             d.room_map[&d.rooms[_rcon_data.room_index].name] = _rcon_data.room_index;
         }
     }
@@ -435,6 +847,7 @@ uint32_t Engine::registerConnection(
 
     if(rgb_color == 0){
         _rcon_data.clear();
+        ++d.registration_failure_count;
         return ErrorNoColor;
     }
 
@@ -450,21 +863,24 @@ uint32_t Engine::registerConnection(
 
     ConnectionStub &rcon = room.connections[_rcon_data.room_entry_index];
 
-    rcon.id = _rctx.recipientId();
+    rcon.pcon_data = &_rcon_data;
 
     rcon.crt_fetch_pos = 0;
     rcon.rgb_color = rgb_color;
     _rrgb_color = rgb_color;
+    room.used_colors.insert(rgb_color);
+    ++d.connection_count;
 
-    solid_log(generic_logger, Info, "Registered connection on room "<<room.name<<" with id "<<_rcon_data.room_entry_index);
+    bubbles_log(generic_logger, Info, "Registered connection on room "<<room.name<<" with id "<<_rcon_data.room_entry_index);
 
-    fetchLastEvents(_rctx, _rcon_data, std::make_shared<EventsNotification>());
+    fetchLastEvents(_rcon_data, d.message_pool.create());
 
     return 0;
 }
 
-void Engine::unregisterConnection(solid::frame::mpipc::ConnectionContext &_rctx, ConnectionData &_rcon_data){
-    solid_log(generic_logger, Warning, " room: "<<_rcon_data.room_index<<" connection: "<<_rcon_data.room_entry_index);
+void Engine::unregisterConnection(ConnectionData &_rcon_data){
+    Data::HandlerTimer handler_timer(d, "unregisterConnection", _rcon_data);
+    bubbles_log(generic_logger, Warning, " room: "<<_rcon_data.room_index<<" connection: "<<_rcon_data.room_entry_index);
     RoomStub    &room = d.rooms[_rcon_data.room_index];
     {
         const size_t        dropped_msg_count = room.connections[_rcon_data.room_entry_index].dropped_message_count;
@@ -477,7 +893,7 @@ void Engine::unregisterConnection(solid::frame::mpipc::ConnectionContext &_rctx,
     {
         ConnectionStub      &rcon_sender = room.connections[_rcon_data.room_entry_index];
 
-        auto close_msg_ptr = std::make_shared<EventsNotification>();
+        auto close_msg_ptr = d.message_pool.create();
         close_msg_ptr->event_stub.sender_rgb_color = rcon_sender.rgb_color;
         //TODO: set:
         //_rrecv_msg_ptr->connection_id
@@ -485,11 +901,13 @@ void Engine::unregisterConnection(solid::frame::mpipc::ConnectionContext &_rctx,
 
         for(size_t i = 0; i < room.connections.size(); ++i){
             ConnectionStub &rcon = room.connections[i];
-            if(i != _rcon_data.room_entry_index){
+            if(i != _rcon_data.room_entry_index and rcon.pcon_data != nullptr and not rcon.suspended){
                 rcon.pending_count += 1;
-                solid::ErrorConditionT err = _rctx.service().sendMessage(rcon.id, close_msg_ptr, {frame::mpipc::MessageFlagsE::Synchronous});
+                solid::ErrorConditionT err = d.sender(*rcon.pcon_data).sendMessage(*rcon.pcon_data, close_msg_ptr);
                 if(err){
                     rcon.pending_count -= 1;
+                }else{
+                    room.messageSent(*close_msg_ptr);
                 }
             }
         }
@@ -506,11 +924,12 @@ void Engine::unregisterConnection(solid::frame::mpipc::ConnectionContext &_rctx,
 
         room.clear();
         d.free_stack.push(_rcon_data.room_index);
-        solid_log(generic_logger, Warning, " room: "<<_rcon_data.room_index<<" is empty");
+        bubbles_log(generic_logger, Warning, " room: "<<_rcon_data.room_index<<" is empty");
     }
 
     _rcon_data.room_index = -1;
     _rcon_data.room_entry_index = -1;
+    --d.connection_count;
 }
 
 
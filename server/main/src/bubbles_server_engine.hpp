@@ -13,12 +13,66 @@ struct ConnectionContext;
 namespace bubbles{
 namespace server{
 
-struct ConnectionData;
+class Sender;
+class MetricsWriter;
+
+//per connection state - kept in the mpipc connection context (or by whoever drives the engine)
+struct ConnectionData{
+    ConnectionData(): room_index(solid::InvalidIndex()), room_entry_index(solid::InvalidIndex()), psender(nullptr){}
+
+    bool registered()const{
+        return room_index != solid::InvalidIndex();
+    }
+
+    void clear(){
+        room_index = -1;
+        room_entry_index = -1;
+    }
+
+    size_t                              room_index;
+    size_t                              room_entry_index;
+    solid::frame::mpipc::RecipientId    recipient_id;//used by the mpipc sender
+    Sender                              *psender;//overrides the engine's sender for this connection - e.g. synthetic members
+};
+
+//Delivers the EventsNotification messages the engine fans out.
+//A successful send must eventually be followed by an Engine::eventsSent call
+//for the same connection and message - that is what releases the pending slots.
+//By default the engine sends through the mpipc service of its connections;
+//benchmarks and tests plug in their own.
+class Sender{
+public:
+    virtual ~Sender(){}
+
+    virtual solid::ErrorConditionT sendMessage(
+        ConnectionData &_rcon_data,
+        std::shared_ptr<EventsNotification> const &_rmsg_ptr
+    ) = 0;
+};
 
 struct EngineConfiguration{
-    EngineConfiguration():connection_max_pending_count(1000){}
+    EngineConfiguration():connection_max_pending_count(1000), stall_threshold_usec(20000){}
 
     size_t      connection_max_pending_count;
+    size_t      stall_threshold_usec;//an entry point running longer is logged as a reactor stall - 0 for never
+};
+
+//engine time spent in the entry points since the previous Engine::takeHandlerTime
+struct HandlerTime{
+    HandlerTime(
+    ):  total_usec(0), call_count(0), handler_name(nullptr), handler_usec(0), handler_call_count(0),
+        room_index(solid::InvalidIndex()), room_usec(0){}
+
+    uint64_t    total_usec;
+    size_t      call_count;
+
+    const char  *handler_name;//the entry point with the most time
+    uint64_t    handler_usec;
+    size_t      handler_call_count;
+
+    std::string room_name;//the room with the most time - empty if no call was for a room
+    size_t      room_index;
+    uint64_t    room_usec;
 };
 
 
@@ -30,6 +84,7 @@ public:
     Engine& operator=(Engine&&) = delete;
 
     Engine(const EngineConfiguration &_config);
+    Engine(const EngineConfiguration &_config, Sender &_rsender);
     ~Engine();
 
 
@@ -71,23 +126,52 @@ public:
         solid::ErrorConditionT const &_rerror
     );
 
+    void onMessage(
+        solid::frame::mpipc::ConnectionContext &_rctx,
+        std::shared_ptr<SuspendNotification> &_rsent_msg_ptr,
+        std::shared_ptr<SuspendNotification> &_rrecv_msg_ptr,
+        solid::ErrorConditionT const &_rerror
+    );
+
     void plotStatistics(std::ostream &);
 
-private:
+    //write the current metrics in Prometheus format - on the engine's thread only
+    //the summary percentiles are reset, they cover the time since the previous call
+    void writeMetrics(MetricsWriter &_rwriter);
+
+    //the entry point time summed over the calls since the previous call, in total,
+    //per entry point and per room - on the engine's thread only
+    //returns false if no entry point was called since
+    bool takeHandlerTime(HandlerTime &_rtime);
 
+    //transport independent entry points - the mpipc callbacks above forward to them
+
+    //returns 0 or an error id
     uint32_t registerConnection(
-        solid::frame::mpipc::ConnectionContext &_rctx,
         ConnectionData &_rcon_data,
         const RegisterRequest &_rreq,
         uint32_t &_rrgb_color
     );
 
-    void unregisterConnection(solid::frame::mpipc::ConnectionContext &_rctx, ConnectionData &_rcon_data);
+    void unregisterConnection(ConnectionData &_rcon_data);
+
+    //an empty message for a transport to receive an EventsNotification into, from the
+    //engine's pool - on the engine's thread only. Once the pool is warm, receiving and
+    //fanning out a move does not allocate. The mpipc receive path does not use it:
+    //its deserializer builds every received message with std::make_shared.
+    std::shared_ptr<EventsNotification> createEventsNotification();
 
+    //_rcon_data sent _rmsg_ptr - fan it out to the room
+    void eventsReceived(ConnectionData &_rcon_data, std::shared_ptr<EventsNotification> &_rmsg_ptr);
+    //_rmsg_ptr was written to _rcon_data
+    void eventsSent(ConnectionData &_rcon_data, std::shared_ptr<EventsNotification> &_rmsg_ptr);
+
+    void suspendConnection(ConnectionData &_rcon_data, const bool _suspend);
+private:
     uint32_t createNewColor(const size_t _room_index);
 
     void fetchLastEvents(
-        solid::frame::mpipc::ConnectionContext &_rctx, ConnectionData &_rcon_data,
+        ConnectionData &_rcon_data,
         std::shared_ptr<EventsNotification> &&_rmsg_ptr
     );
 private:
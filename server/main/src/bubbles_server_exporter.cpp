@@ -0,0 +1,96 @@
+#include "bubbles_server_exporter.hpp"
+#include "bubbles_server_metrics.hpp"
+
+#include "solid/frame/aio/aioreactorcontext.hpp"
+#include "solid/frame/aio/aiotimer.hpp"
+#include "protocol/bubbles_log.hpp"
+#include "solid/utility/event.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+using namespace solid;
+using namespace std;
+
+namespace bubbles{
+namespace server{
+
+struct MetricsExporter::Data{
+    Data(
+        MetricsExporter &_robj, Engine &_rengine, const ByteCounters &_rbyte_counters,
+        const StallMonitor::PointerT &_stall_monitor_ptr, const ExporterConfiguration &_rcfg
+    ):  engine(_rengine), byte_counters(_rbyte_counters), stall_monitor_ptr(_stall_monitor_ptr),
+        cfg(_rcfg), tmp_path(_rcfg.path + ".tmp"), timer(_robj.proxy()){}
+
+    Engine                      &engine;
+    const ByteCounters          &byte_counters;
+    StallMonitor::PointerT      stall_monitor_ptr;
+    const ExporterConfiguration cfg;
+    const std::string           tmp_path;
+    frame::aio::SteadyTimer     timer;
+};
+
+MetricsExporter::MetricsExporter(
+    Engine &_rengine, const ByteCounters &_rbyte_counters,
+    const StallMonitor::PointerT &_stall_monitor_ptr,
+    const ExporterConfiguration &_rcfg
+):d(*(new Data(*this, _rengine, _rbyte_counters, _stall_monitor_ptr, _rcfg))){}
+
+MetricsExporter::~MetricsExporter(){
+    delete &d;
+}
+
+void MetricsExporter::onEvent(frame::aio::ReactorContext &_rctx, solid::Event &&_uevent) /*override*/{
+    bubbles_log(generic_logger, Info, " event = "<<_uevent);
+    if(generic_event_category.event(GenericEvents::Start) == _uevent){
+        onTimer(_rctx);
+    }else if(generic_event_category.event(GenericEvents::Kill) == _uevent){
+        doExport();//the final values
+        postStop(_rctx);
+    }
+}
+
+void MetricsExporter::onTimer(frame::aio::ReactorContext &_rctx){
+    doExport();
+
+    d.timer.waitUntil(
+        _rctx, _rctx.steadyTime() + std::chrono::milliseconds(d.cfg.interval_msec),
+        [this](frame::aio::ReactorContext &_rctx){onTimer(_rctx);}
+    );
+}
+
+void MetricsExporter::doExport(){
+    {
+        ofstream        ofs(d.tmp_path, ios::out | ios::trunc);
+        MetricsWriter   writer(ofs);
+
+        if(not ofs){
+            bubbles_log(generic_logger, Error, "cannot open metrics file: "<<d.tmp_path);
+            return;
+        }
+
+        d.engine.writeMetrics(writer);
+        if(d.stall_monitor_ptr){
+            d.stall_monitor_ptr->writeMetrics(writer);
+        }
+
+        writer.family("bubbles_sent_raw_bytes_total", "counter", "Outgoing payload before compression");
+        writer.sample("bubbles_sent_raw_bytes_total", "", d.byte_counters.raw_byte_count.load(std::memory_order_relaxed));
+
+        writer.family("bubbles_sent_compressed_bytes_total", "counter", "Outgoing payload after compression");
+        writer.sample("bubbles_sent_compressed_bytes_total", "", d.byte_counters.compressed_byte_count.load(std::memory_order_relaxed));
+
+        ofs.flush();
+        if(not ofs){
+            bubbles_log(generic_logger, Error, "cannot write metrics file: "<<d.tmp_path);
+            return;
+        }
+    }
+    if(std::rename(d.tmp_path.c_str(), d.cfg.path.c_str()) != 0){
+        bubbles_log(generic_logger, Error, "cannot rename "<<d.tmp_path<<" to "<<d.cfg.path);
+    }
+}
+
+}//namespace server
+}//namespace bubbles
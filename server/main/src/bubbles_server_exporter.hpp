@@ -0,0 +1,65 @@
+#ifndef BUBBLES_SERVER_EXPORTER_HPP
+#define BUBBLES_SERVER_EXPORTER_HPP
+
+#include "bubbles_server_engine.hpp"
+#include "bubbles_server_stall.hpp"
+
+#include "protocol/bubbles_compress_counter.hpp"
+
+#include "solid/frame/aio/aioobject.hpp"
+#include "solid/frame/service.hpp"
+#include "solid/utility/dynamicpointer.hpp"
+
+#include <atomic>
+#include <string>
+
+namespace solid{namespace frame{namespace aio{
+struct ReactorContext;
+}}}
+
+namespace bubbles{
+namespace server{
+
+struct ExporterConfiguration{
+    ExporterConfiguration():interval_msec(5000){}
+
+    std::string path;
+    size_t      interval_msec;
+};
+
+//Periodically writes the Engine metrics to a file, in Prometheus text format -
+//for the node_exporter textfile collector or anything else that can read a file.
+//The file is written next to path and renamed over it, so a reader never sees half of it.
+//Runs on the aio reactor of the Engine - the Engine is never touched from another thread.
+class MetricsExporter: public solid::Dynamic<MetricsExporter, solid::frame::aio::Object>{
+public:
+    using PointerT = solid::DynamicPointer<MetricsExporter>;
+
+    //_stall_monitor_ptr can be empty - it must run on the same reactor
+    static PointerT create(
+        Engine &_rengine, const ByteCounters &_rbyte_counters,
+        const StallMonitor::PointerT &_stall_monitor_ptr,
+        const ExporterConfiguration &_rcfg
+    ){
+        return PointerT(new MetricsExporter(_rengine, _rbyte_counters, _stall_monitor_ptr, _rcfg));
+    }
+private:
+    MetricsExporter(
+        Engine &_rengine, const ByteCounters &_rbyte_counters,
+        const StallMonitor::PointerT &_stall_monitor_ptr,
+        const ExporterConfiguration &_rcfg
+    );
+    ~MetricsExporter();
+
+    void onEvent(solid::frame::aio::ReactorContext &_rctx, solid::Event &&_uevent) override;
+    void onTimer(solid::frame::aio::ReactorContext &_rctx);
+    void doExport();
+private:
+    struct Data;
+    Data    &d;
+};
+
+}//namespace server
+}//namespace bubbles
+
+#endif
@@ -11,14 +11,20 @@
 #include "solid/frame/mpipc/mpipccompression_snappy.hpp"
 
 #include "protocol/bubbles_messages.hpp"
+#include "protocol/bubbles_compress_counter.hpp"
 
 #include "bubbles_server_engine.hpp"
+#include "bubbles_server_synthetic.hpp"
+#include "bubbles_server_exporter.hpp"
+#include "bubbles_server_stall.hpp"
+#include "bubbles_server_trace.hpp"
 
 #include <signal.h>
 
 #include "boost/program_options.hpp"
 
 #include <iostream>
+#include <fstream>
 
 using namespace solid;
 using namespace std;
@@ -41,6 +47,14 @@ struct Parameters{
     bool                    compress;
     string                  listener_port;
     string                  listener_addr;
+
+    bubbles::server::SyntheticConfiguration synthetic;
+    bubbles::server::ExporterConfiguration  metrics;
+    bubbles::server::StallConfiguration     stall;
+
+    size_t                  trace_span_count;
+    size_t                  trace_sample;
+    string                  trace_path;
 };
 
 //-----------------------------------------------------------------------------
@@ -48,6 +62,8 @@ struct Parameters{
 namespace bubbles{
 namespace server{
 
+const trace::SpanType compress_span{"compress", "raw_bytes", "compressed_bytes", false};
+
 struct MessageSetup {
     Engine &engine;
 
@@ -106,16 +122,27 @@ int main(int argc, char *argv[]){
             1024 * 1024 * 64);
     }
 
+    bubbles::server::trace::configure(params.trace_span_count, params.trace_sample);
+
     {
 
         AioSchedulerT               scheduler;
 
 
-        bubbles::server::Engine     engine(bubbles::server::EngineConfiguration{});
+        bubbles::server::EngineConfiguration engine_cfg;
+
+        engine_cfg.stall_threshold_usec = params.stall.threshold_usec;
+
+        bubbles::server::Engine     engine(engine_cfg);
+        bubbles::ByteCounters       byte_counters;//used by ipcservice
         frame::Manager              manager;
         frame::mpipc::ServiceT      ipcservice(manager);
+        frame::ServiceT             object_service(manager);//the aio objects next to the mpipc connections
         ErrorConditionT             err;
 
+        bubbles::server::SyntheticMembers::PointerT synthetic_ptr;
+        bubbles::server::StallMonitor::PointerT     stall_monitor_ptr;
+
         err = scheduler.start(1);
 
         if(err){
@@ -168,6 +195,24 @@ int main(int argc, char *argv[]){
             if(params.compress){
                 frame::mpipc::snappy::setup(cfg);
             }
+            if(params.metrics.path.size()){
+                bubbles::count_sent_bytes(cfg, byte_counters);
+            }
+            if(params.trace_span_count){
+                //trace the outgoing payload on its way through the compressor
+                auto compress_fnc = cfg.writer.inplace_compress_fnc;
+
+                cfg.writer.inplace_compress_fnc = [compress_fnc](char *_pdata, size_t _len, ErrorConditionT &_rerror) mutable -> size_t{
+                    using namespace bubbles::server;
+                    const uint64_t  start_nsec = trace::enabled() ? trace::now() : 0;
+                    const size_t    rv = compress_fnc ? compress_fnc(_pdata, _len, _rerror) : 0;
+
+                    if(start_nsec){
+                        trace::record(compress_span, start_nsec, trace::now(), bubbles::serializing_trace_id(), _len, rv ? rv : _len);
+                    }
+                    return rv;
+                };
+            }
 
             err = ipcservice.reconfigure(std::move(cfg));
 
@@ -183,10 +228,73 @@ int main(int argc, char *argv[]){
             }
         }
 
-        cout << "Press ENTER to stop:" << endl;
-        cin.ignore();
+        if(params.synthetic.member_count){
+            //on the scheduler of the mpipc service - the engine is only used from its single thread
+            synthetic_ptr = bubbles::server::SyntheticMembers::create(object_service, engine, params.synthetic);
+
+            solid::DynamicPointer<frame::aio::Object> objptr(synthetic_ptr);
+
+            scheduler.startObject(objptr, object_service, generic_event_category.event(GenericEvents::Start), err);
+
+            if(err){
+                cout<<"Error starting synthetic members: "<<err.message()<<endl;
+                manager.stop();
+                return 1;
+            }
+            cout<<"Synthetic members: "<<params.synthetic.member_count<<" in room "<<params.synthetic.room_name<<endl;
+        }
+
+        if(params.stall.threshold_usec){
+            //the lag it measures is that of the reactor the mpipc connections and the engine run on
+            stall_monitor_ptr = bubbles::server::StallMonitor::create(engine, params.stall);
+
+            solid::DynamicPointer<frame::aio::Object> objptr(stall_monitor_ptr);
+
+            scheduler.startObject(objptr, object_service, generic_event_category.event(GenericEvents::Start), err);
+
+            if(err){
+                cout<<"Error starting stall monitor: "<<err.message()<<endl;
+                manager.stop();
+                return 1;
+            }
+        }
+
+        if(params.metrics.path.size()){
+            //also on the scheduler of the mpipc service - it reads the engine
+            solid::DynamicPointer<frame::aio::Object> objptr(bubbles::server::MetricsExporter::create(engine, byte_counters, stall_monitor_ptr, params.metrics));
+
+            scheduler.startObject(objptr, object_service, generic_event_category.event(GenericEvents::Start), err);
+
+            if(err){
+                cout<<"Error starting metrics exporter: "<<err.message()<<endl;
+                manager.stop();
+                return 1;
+            }
+            cout<<"Metrics file: "<<params.metrics.path<<endl;
+        }
+
+        if(params.trace_span_count){
+            string line;
+
+            cout << "Type trace and press ENTER to write "<<params.trace_path<<", press ENTER to stop:" << endl;
+            while(getline(cin, line) and line == "trace"){
+                ofstream ofs(params.trace_path);
+
+                bubbles::server::trace::dump(ofs);
+                cout<<(ofs ? "Trace written to " : "Failed writing trace to ")<<params.trace_path<<endl;
+            }
+        }else{
+            cout << "Press ENTER to stop:" << endl;
+            cin.ignore();
+        }
         //cout<<"Max dropped message count: "<<engine.maxDroppedMessageCount()<<endl;
         engine.plotStatistics(cout);
+        if(synthetic_ptr){
+            synthetic_ptr->plotStatistics(cout);
+        }
+        if(stall_monitor_ptr){
+            stall_monitor_ptr->plotStatistics(cout);
+        }
     }
     return 0;
 }
@@ -209,6 +317,20 @@ bool parseArguments(Parameters &_par, int argc, char *argv[]){
             ("listen-addr,a", value<std::string>(&_par.listener_addr)->default_value("0.0.0.0"), "IPC Listen address")
             ("secure,s", value<bool>(&_par.secure)->implicit_value(true)->default_value(true), "Use SSL to secure communication")
             ("compress", value<bool>(&_par.compress)->implicit_value(true)->default_value(true), "Use Snappy to compress communication")
+            ("synthetic-members", value<size_t>(&_par.synthetic.member_count)->default_value(0), "In-process members to host - for capacity testing")
+            ("synthetic-room", value<std::string>(&_par.synthetic.room_name)->default_value("synthetic"), "Room of the synthetic members")
+            ("synthetic-seed", value<uint32_t>(&_par.synthetic.seed)->default_value(1), "Seed of the synthetic trajectories and colors")
+            ("synthetic-move-msec", value<size_t>(&_par.synthetic.move_interval_msec)->default_value(64), "Milliseconds between two moves of a synthetic member")
+            ("synthetic-samples", value<size_t>(&_par.synthetic.samples_per_move)->default_value(4), "Positions carried by a synthetic move")
+            ("synthetic-join-per-tick", value<size_t>(&_par.synthetic.join_per_tick)->default_value(500), "Synthetic members joining every 16 milliseconds")
+            ("synthetic-receive", value<bool>(&_par.synthetic.receive)->implicit_value(true)->default_value(false), "Fan out to the synthetic members too - measures the recipient cost")
+            ("metrics-file", value<std::string>(&_par.metrics.path), "Periodically write the metrics there, in Prometheus text format")
+            ("metrics-msec", value<size_t>(&_par.metrics.interval_msec)->default_value(5000), "Milliseconds between two metrics writes")
+            ("stall-usec", value<size_t>(&_par.stall.threshold_usec)->default_value(20000), "Log reactor lags and engine calls longer than this - 0 for no stall monitor")
+            ("stall-tick-msec", value<size_t>(&_par.stall.tick_msec)->default_value(10), "Milliseconds between two reactor lag samples")
+            ("trace-spans", value<size_t>(&_par.trace_span_count)->default_value(0), "Message lifecycle spans kept per thread - 0 for no tracing")
+            ("trace-sample", value<size_t>(&_par.trace_sample)->default_value(1), "Trace one message in every trace-sample")
+            ("trace-file", value<std::string>(&_par.trace_path)->default_value("bubbles_trace.json"), "Where to write the trace, in Chrome trace format, on demand")
         ;
         variables_map vm;
         store(parse_command_line(argc, argv, desc), vm);
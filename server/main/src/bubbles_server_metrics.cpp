@@ -0,0 +1,88 @@
+#include "bubbles_server_metrics.hpp"
+
+#include <iomanip>
+
+using namespace std;
+
+namespace bubbles{
+namespace server{
+
+namespace{
+
+void write_labels(ostream &_ros, const string &_labels, const char *_extra = nullptr){
+    if(_labels.empty() and _extra == nullptr){
+        return;
+    }
+    _ros<<'{'<<_labels;
+    if(_extra){
+        if(_labels.size()){
+            _ros<<',';
+        }
+        _ros<<_extra;
+    }
+    _ros<<'}';
+}
+
+}//namespace
+
+void MetricsWriter::family(const char *_name, const char *_type, const char *_help){
+    ros<<"# HELP "<<_name<<' '<<_help<<'\n';
+    ros<<"# TYPE "<<_name<<' '<<_type<<'\n';
+}
+
+void MetricsWriter::sample(const char *_name, const std::string &_labels, const uint64_t _value){
+    ros<<_name;
+    write_labels(ros, _labels);
+    ros<<' '<<_value<<'\n';
+}
+
+void MetricsWriter::summary(const char *_name, const std::string &_labels, const MetricsSummary &_rsummary, const double _scale){
+    static const struct{
+        const char  *label;
+        double      percent;
+    } quantiles[] = {
+        {"quantile=\"0.5\"", 50},
+        {"quantile=\"0.9\"", 90},
+        {"quantile=\"0.99\"", 99},
+        {"quantile=\"0.999\"", 99.9},
+    };
+
+    //the default 6 digits would round big sums - a double needs 17 to round trip
+    ros<<std::setprecision(17);
+
+    for(const auto &rquantile: quantiles){
+        ros<<_name;
+        write_labels(ros, _labels, rquantile.label);
+        if(_rsummary.histogram().count()){
+            ros<<' '<<_rsummary.histogram().percentile(rquantile.percent) * _scale<<'\n';
+        }else{
+            ros<<" NaN\n";
+        }
+    }
+    ros<<_name<<"_sum";
+    write_labels(ros, _labels);
+    ros<<' '<<_rsummary.sum() * _scale<<'\n';
+
+    ros<<_name<<"_count";
+    write_labels(ros, _labels);
+    ros<<' '<<_rsummary.count()<<'\n';
+}
+
+std::string MetricsWriter::label(const char *_name, const std::string &_value){
+    string rv(_name);
+
+    rv += "=\"";
+    for(const char c: _value){
+        switch(c){
+            case '\\': rv += "\\\\"; break;
+            case '"': rv += "\\\""; break;
+            case '\n': rv += "\\n"; break;
+            default: rv += c;
+        }
+    }
+    rv += '"';
+    return rv;
+}
+
+}//namespace server
+}//namespace bubbles
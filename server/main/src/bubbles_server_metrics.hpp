@@ -0,0 +1,68 @@
+#ifndef BUBBLES_SERVER_METRICS_HPP
+#define BUBBLES_SERVER_METRICS_HPP
+
+#include "protocol/bubbles_latency_histogram.hpp"
+
+#include <ostream>
+#include <string>
+
+namespace bubbles{
+namespace server{
+
+//distribution of a value - the percentiles are over the samples since the last export,
+//count and sum are since start, as Prometheus expects from a summary
+class MetricsSummary{
+public:
+    MetricsSummary():total_count(0), total_sum(0){}
+
+    void record(const uint64_t _value){
+        window.record(_value);
+        ++total_count;
+        total_sum += _value;
+    }
+
+    const LatencyHistogram& histogram()const{
+        return window;
+    }
+
+    uint64_t count()const{
+        return total_count;
+    }
+
+    uint64_t sum()const{
+        return total_sum;
+    }
+
+    void clearWindow(){
+        window.clear();
+    }
+private:
+    LatencyHistogram    window;
+    uint64_t            total_count;
+    uint64_t            total_sum;
+};
+
+//Writes metrics in the Prometheus text exposition format (0.0.4).
+//Every family() must be followed by the samples of that family.
+//_labels is a comma separated list of label pairs built with label(), or empty.
+class MetricsWriter{
+public:
+    MetricsWriter(std::ostream &_ros):ros(_ros){}
+
+    //_type: counter, gauge or summary
+    void family(const char *_name, const char *_type, const char *_help);
+
+    void sample(const char *_name, const std::string &_labels, const uint64_t _value);
+
+    //_scale converts the recorded unit to the exported one - e.g. 1e-9 for nanoseconds to seconds
+    void summary(const char *_name, const std::string &_labels, const MetricsSummary &_rsummary, const double _scale = 1.0);
+
+    static std::string label(const char *_name, const std::string &_value);
+private:
+    std::ostream    &ros;
+};
+
+}//namespace server
+}//namespace bubbles
+
+#endif
@@ -0,0 +1,108 @@
+#include "bubbles_server_stall.hpp"
+#include "bubbles_server_metrics.hpp"
+
+#include "solid/frame/aio/aioreactorcontext.hpp"
+#include "solid/frame/aio/aiotimer.hpp"
+#include "protocol/bubbles_log.hpp"
+#include "solid/utility/event.hpp"
+
+#include <atomic>
+#include <chrono>
+
+using namespace solid;
+using namespace std;
+
+namespace bubbles{
+namespace server{
+
+struct StallMonitor::Data{
+    Data(
+        StallMonitor &_robj, Engine &_rengine, const StallConfiguration &_rcfg
+    ):  engine(_rengine), cfg(_rcfg), timer(_robj.proxy()), stall_count(0), max_lag_usec(0){}
+
+    Engine                                  &engine;
+    const StallConfiguration                cfg;
+    frame::aio::SteadyTimer                 timer;
+    std::chrono::steady_clock::time_point   deadline;
+    MetricsSummary                          lag_usec;
+    HandlerTime                             handler_time;
+
+    //read by plotStatistics from other threads
+    std::atomic<uint64_t>                   stall_count;
+    std::atomic<uint64_t>                   max_lag_usec;
+};
+
+StallMonitor::StallMonitor(
+    Engine &_rengine, const StallConfiguration &_rcfg
+):d(*(new Data(*this, _rengine, _rcfg))){}
+
+StallMonitor::~StallMonitor(){
+    delete &d;
+}
+
+void StallMonitor::writeMetrics(MetricsWriter &_rwriter){
+    _rwriter.family("bubbles_reactor_lag_seconds", "summary", "How late the reactor ran a timer");
+    _rwriter.summary("bubbles_reactor_lag_seconds", "", d.lag_usec, 1e-6);
+
+    _rwriter.family("bubbles_reactor_stalls_total", "counter", "Timers run later than the stall threshold");
+    _rwriter.sample("bubbles_reactor_stalls_total", "", d.stall_count.load(std::memory_order_relaxed));
+
+    d.lag_usec.clearWindow();
+}
+
+void StallMonitor::plotStatistics(std::ostream &_ros)const{
+    _ros<<"Reactor stalls: "<<d.stall_count<<" max lag: "<<d.max_lag_usec<<"usec"<<endl;
+}
+
+void StallMonitor::onEvent(frame::aio::ReactorContext &_rctx, solid::Event &&_uevent) /*override*/{
+    bubbles_log(generic_logger, Info, " event = "<<_uevent);
+    if(generic_event_category.event(GenericEvents::Start) == _uevent){
+        d.engine.takeHandlerTime(d.handler_time);
+        doWait(_rctx);
+    }else if(generic_event_category.event(GenericEvents::Kill) == _uevent){
+        postStop(_rctx);
+    }
+}
+
+void StallMonitor::doWait(frame::aio::ReactorContext &_rctx){
+    d.deadline = _rctx.steadyTime() + std::chrono::milliseconds(d.cfg.tick_msec);
+    d.timer.waitUntil(
+        _rctx, d.deadline,
+        [this](frame::aio::ReactorContext &_rctx){onTimer(_rctx);}
+    );
+}
+
+void StallMonitor::onTimer(frame::aio::ReactorContext &_rctx){
+    const auto      now = std::chrono::steady_clock::now();
+    const uint64_t  lag_usec = now > d.deadline ? std::chrono::duration_cast<std::chrono::microseconds>(now - d.deadline).count() : 0;
+
+    d.lag_usec.record(lag_usec);
+
+    if(lag_usec > d.max_lag_usec.load(std::memory_order_relaxed)){
+        d.max_lag_usec.store(lag_usec, std::memory_order_relaxed);
+    }
+
+    const bool has_handler = d.engine.takeHandlerTime(d.handler_time);
+
+    if(d.cfg.threshold_usec and lag_usec >= d.cfg.threshold_usec){
+        const HandlerTime &rht = d.handler_time;
+
+        ++d.stall_count;
+        if(has_handler and rht.total_usec * 2 >= lag_usec){
+            bubbles_log(
+                generic_logger, Warning, "reactor stall: "<<lag_usec<<"usec late - engine calls took "<<rht.total_usec<<"usec in "<<rht.call_count<<" calls, most in "
+                <<rht.handler_name<<" ("<<rht.handler_usec<<"usec in "<<rht.handler_call_count<<" calls) and on room "
+                <<rht.room_name<<" ("<<rht.room_index<<") "<<rht.room_usec<<"usec"
+            );
+        }else{
+            bubbles_log(
+                generic_logger, Warning, "reactor stall: "<<lag_usec<<"usec late - not in the engine (engine calls took "
+                <<(has_handler ? rht.total_usec : 0)<<"usec) - TLS, compression or socket I/O"
+            );
+        }
+    }
+    doWait(_rctx);
+}
+
+}//namespace server
+}//namespace bubbles
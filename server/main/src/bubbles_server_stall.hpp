@@ -0,0 +1,62 @@
+#ifndef BUBBLES_SERVER_STALL_HPP
+#define BUBBLES_SERVER_STALL_HPP
+
+#include "bubbles_server_engine.hpp"
+
+#include "solid/frame/aio/aioobject.hpp"
+#include "solid/utility/dynamicpointer.hpp"
+
+#include <ostream>
+
+namespace solid{namespace frame{namespace aio{
+struct ReactorContext;
+}}}
+
+namespace bubbles{
+namespace server{
+
+class MetricsWriter;
+
+struct StallConfiguration{
+    StallConfiguration():tick_msec(10), threshold_usec(20000){}
+
+    size_t      tick_msec;
+    size_t      threshold_usec;//a tick later than this is a stall - 0 for no stall reports
+};
+
+//Measures how late the aio reactor of the Engine runs: a timer is armed every
+//tick_msec and the time between its deadline and its call is the reactor lag -
+//the time the other connections of the reactor waited too.
+//A stall is blamed on the Engine when the time its calls took during the tick, summed,
+//accounts for at least half of the lag - the report names the entry point and the room
+//with the most time; otherwise the time went to mpipc itself (TLS handshakes,
+//compression, socket I/O).
+class StallMonitor: public solid::Dynamic<StallMonitor, solid::frame::aio::Object>{
+public:
+    using PointerT = solid::DynamicPointer<StallMonitor>;
+
+    static PointerT create(Engine &_rengine, const StallConfiguration &_rcfg){
+        return PointerT(new StallMonitor(_rengine, _rcfg));
+    }
+
+    //on the reactor thread only
+    void writeMetrics(MetricsWriter &_rwriter);
+
+    //can be called from any thread
+    void plotStatistics(std::ostream &_ros)const;
+private:
+    StallMonitor(Engine &_rengine, const StallConfiguration &_rcfg);
+    ~StallMonitor();
+
+    void onEvent(solid::frame::aio::ReactorContext &_rctx, solid::Event &&_uevent) override;
+    void onTimer(solid::frame::aio::ReactorContext &_rctx);
+    void doWait(solid::frame::aio::ReactorContext &_rctx);
+private:
+    struct Data;
+    Data    &d;
+};
+
+}//namespace server
+}//namespace bubbles
+
+#endif
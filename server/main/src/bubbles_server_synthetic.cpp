@@ -0,0 +1,265 @@
+#include "bubbles_server_synthetic.hpp"
+#include "protocol/bubbles_message_pool.hpp"
+
+#include "solid/frame/aio/aioreactorcontext.hpp"
+#include "solid/frame/aio/aiotimer.hpp"
+#include "solid/frame/manager.hpp"
+#include "protocol/bubbles_log.hpp"
+#include "solid/utility/event.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+using namespace solid;
+using namespace std;
+
+namespace bubbles{
+namespace server{
+
+namespace{
+
+using EventsNotificationPointerT = std::shared_ptr<EventsNotification>;
+
+//same canvas as the client engine
+const int canvas_width = 7680;
+const int canvas_height = 7680;
+
+struct Member{
+    Member():x(0), y(0), target_x(0), target_y(0), rgb_color(0){}
+
+    ConnectionData  con_data;
+    int             x;
+    int             y;
+    int             target_x;
+    int             target_y;
+    uint32_t        rgb_color;
+};
+
+using MemberVectorT = vector<Member>;
+
+struct Delivery{
+    ConnectionData              *pcon_data;
+    EventsNotificationPointerT  msg_ptr;
+};
+
+using DeliveryVectorT = vector<Delivery>;
+
+}//namespace
+
+//the Sender of the members - what the Engine sends them is completed on the next Raise event
+struct SyntheticMembers::Data: Sender{
+    Data(
+        SyntheticMembers &_robj, frame::ServiceT &_rsvc, Engine &_rengine,
+        const SyntheticConfiguration &_rcfg
+    ):  robj(_robj), service(_rsvc), engine(_rengine), cfg(_rcfg), members(_rcfg.member_count),
+        rng(_rcfg.seed), dist_x(0, canvas_width - 1), dist_y(0, canvas_height - 1),
+        dist_color(1, 0xffffff), joined_count(0), move_pos(0), move_credit(0.0), timer(_robj.proxy()),
+        move_count(0), move_event_count(0), delivery_count(0), delivery_event_count(0), joined(0)
+    {
+        unordered_set<uint32_t> colors;
+
+        for(auto &rmember: members){
+            rmember.con_data.psender = this;
+            rmember.x = dist_x(rng);
+            rmember.y = dist_y(rng);
+            rmember.target_x = dist_x(rng);
+            rmember.target_y = dist_y(rng);
+            do{
+                rmember.rgb_color = dist_color(rng);
+            }while(not colors.insert(rmember.rgb_color).second);
+        }
+    }
+
+    solid::ErrorConditionT sendMessage(
+        ConnectionData &_rcon_data,
+        EventsNotificationPointerT const &_rmsg_ptr
+    ) override{
+        deliveries.push_back(Delivery{&_rcon_data, _rmsg_ptr});
+        if(deliveries.size() == 1){
+            service.manager().notify(service.manager().id(robj), generic_event_category.event(GenericEvents::Raise));
+        }
+        return solid::ErrorConditionT();
+    }
+
+    //one sample _rmember.speed closer to its waypoint - a new waypoint once it is reached
+    void step(Member &_rmember){
+        const double dx = _rmember.target_x - _rmember.x;
+        const double dy = _rmember.target_y - _rmember.y;
+        const double distance = std::sqrt(dx * dx + dy * dy);
+
+        if(distance <= cfg.speed){
+            _rmember.x = _rmember.target_x;
+            _rmember.y = _rmember.target_y;
+            _rmember.target_x = dist_x(rng);
+            _rmember.target_y = dist_y(rng);
+        }else{
+            _rmember.x += static_cast<int>(dx * cfg.speed / distance);
+            _rmember.y += static_cast<int>(dy * cfg.speed / distance);
+        }
+    }
+
+    Event nextEvent(Member &_rmember){
+        step(_rmember);
+
+        Event event(Event::PointerMove);
+        event.x = _rmember.x;
+        event.y = _rmember.y;
+        return event;
+    }
+
+    SyntheticMembers                    &robj;
+    frame::ServiceT                     &service;
+    Engine                              &engine;
+    const SyntheticConfiguration        cfg;
+    MemberVectorT                       members;//never resized - the Engine keeps pointers to the con_data
+    std::mt19937                        rng;
+    std::uniform_int_distribution<int>  dist_x;
+    std::uniform_int_distribution<int>  dist_y;
+    std::uniform_int_distribution<uint32_t> dist_color;
+    size_t                              joined_count;
+    size_t                              move_pos;//next member to move
+    double                              move_credit;//fraction of a move carried to the next tick
+    DeliveryVectorT                     deliveries;
+    MessagePool<EventsNotification>     message_pool;
+    frame::aio::SteadyTimer             timer;
+
+    //read by plotStatistics from other threads
+    std::atomic<uint64_t>               move_count;
+    std::atomic<uint64_t>               move_event_count;
+    std::atomic<uint64_t>               delivery_count;
+    std::atomic<uint64_t>               delivery_event_count;
+    std::atomic<size_t>                 joined;
+};
+
+SyntheticMembers::SyntheticMembers(
+    solid::frame::ServiceT &_rsvc, Engine &_rengine,
+    const SyntheticConfiguration &_rcfg
+):d(*(new Data(*this, _rsvc, _rengine, _rcfg))){}
+
+SyntheticMembers::~SyntheticMembers(){
+    delete &d;
+}
+
+void SyntheticMembers::plotStatistics(std::ostream &_ros)const{
+    _ros<<"Synthetic members: "<<d.joined<<'/'<<d.members.size()<<" in room "<<d.cfg.room_name
+        <<" moves: "<<d.move_count<<" (events: "<<d.move_event_count<<')'
+        <<" received: "<<d.delivery_count<<" (events: "<<d.delivery_event_count<<')'<<endl;
+}
+
+void SyntheticMembers::onEvent(frame::aio::ReactorContext &_rctx, solid::Event &&_uevent) /*override*/{
+    bubbles_log(generic_logger, Info, " event = "<<_uevent);
+    if(generic_event_category.event(GenericEvents::Start) == _uevent){
+        onTimer(_rctx);
+    }else if(generic_event_category.event(GenericEvents::Raise) == _uevent){
+        doCompleteDeliveries();
+    }else if(generic_event_category.event(GenericEvents::Kill) == _uevent){
+        doStop(_rctx);
+    }
+}
+
+void SyntheticMembers::onTimer(frame::aio::ReactorContext &_rctx){
+    doJoin();
+    doMove();
+    doCompleteDeliveries();
+
+    d.timer.waitUntil(
+        _rctx, _rctx.steadyTime() + std::chrono::milliseconds(d.cfg.tick_msec),
+        [this](frame::aio::ReactorContext &_rctx){onTimer(_rctx);}
+    );
+}
+
+void SyntheticMembers::doJoin(){
+    const size_t join_end = std::min(d.members.size(), d.joined_count + std::max(d.cfg.join_per_tick, static_cast<size_t>(1)));
+
+    for(; d.joined_count < join_end; ++d.joined_count){
+        Member          &rmember = d.members[d.joined_count];
+        uint32_t        rgb_color = 0;
+        const uint32_t  error_id = d.engine.registerConnection(rmember.con_data, RegisterRequest(d.cfg.room_name, rmember.rgb_color), rgb_color);
+
+        if(error_id != 0){
+            bubbles_log(generic_logger, Error, "synthetic member "<<d.joined_count<<" failed to register: "<<error_id);
+            continue;
+        }
+        if(not d.cfg.receive){
+            d.engine.suspendConnection(rmember.con_data, true);
+        }
+        rmember.rgb_color = rgb_color;
+        ++d.joined;
+    }
+}
+
+//the joined members take turns so that every one of them moves once per move_interval_msec
+void SyntheticMembers::doMove(){
+    if(d.joined_count == 0){
+        return;
+    }
+    d.move_credit += static_cast<double>(d.joined_count * d.cfg.tick_msec) / std::max(d.cfg.move_interval_msec, static_cast<size_t>(1));
+
+    size_t move_count = static_cast<size_t>(d.move_credit);
+
+    d.move_credit -= move_count;
+
+    for(; move_count; --move_count){
+        if(d.move_pos >= d.joined_count){
+            d.move_pos = 0;
+        }
+        Member &rmember = d.members[d.move_pos++];
+
+        if(not rmember.con_data.registered()){
+            continue;
+        }
+
+        auto msg_ptr = d.message_pool.create();
+
+        msg_ptr->event_stub.event = d.nextEvent(rmember);
+        for(size_t i = 1; i < d.cfg.samples_per_move; ++i){
+            msg_ptr->event_stub.events.push_back(d.nextEvent(rmember));
+        }
+
+        ++d.move_count;
+        d.move_event_count += 1 + msg_ptr->event_stub.events.size();
+
+        d.engine.eventsReceived(rmember.con_data, msg_ptr);
+    }
+}
+
+//a completion can queue more (join snapshot continuation)
+void SyntheticMembers::doCompleteDeliveries(){
+    for(size_t i = 0; i < d.deliveries.size(); ++i){
+        ConnectionData              *pcon_data = d.deliveries[i].pcon_data;
+        EventsNotificationPointerT  msg_ptr = std::move(d.deliveries[i].msg_ptr);
+
+        ++d.delivery_count;
+        d.delivery_event_count += 1 + msg_ptr->event_stub.events.size() + msg_ptr->event_stubs.size();
+
+        if(pcon_data->registered()){
+            d.engine.eventsSent(*pcon_data, msg_ptr);
+        }
+    }
+    d.deliveries.clear();
+}
+
+void SyntheticMembers::doStop(frame::aio::ReactorContext &_rctx){
+    //suspend all first so that no departure is fanned out to the other synthetic members
+    for(size_t i = 0; i < d.joined_count; ++i){
+        if(d.members[i].con_data.registered()){
+            d.engine.suspendConnection(d.members[i].con_data, true);
+        }
+    }
+    for(size_t i = 0; i < d.joined_count; ++i){
+        if(d.members[i].con_data.registered()){
+            d.engine.unregisterConnection(d.members[i].con_data);
+        }
+    }
+    d.joined = 0;
+    d.deliveries.clear();
+    postStop(_rctx);
+}
+
+}//namespace server
+}//namespace bubbles
@@ -0,0 +1,75 @@
+#ifndef BUBBLES_SERVER_SYNTHETIC_HPP
+#define BUBBLES_SERVER_SYNTHETIC_HPP
+
+#include "bubbles_server_engine.hpp"
+
+#include "solid/frame/aio/aioobject.hpp"
+#include "solid/frame/service.hpp"
+#include "solid/utility/dynamicpointer.hpp"
+
+#include <ostream>
+#include <string>
+
+namespace solid{namespace frame{namespace aio{
+struct ReactorContext;
+}}}
+
+namespace bubbles{
+namespace server{
+
+struct SyntheticConfiguration{
+    SyntheticConfiguration(
+    ):  member_count(0), room_name("synthetic"), seed(1), move_interval_msec(64),
+        samples_per_move(4), speed(24), join_per_tick(500), tick_msec(16), receive(false){}
+
+    size_t      member_count;
+    std::string room_name;
+    uint32_t    seed;//same seed, same trajectories and colors
+    size_t      move_interval_msec;//every member sends a move once per interval
+    size_t      samples_per_move;//positions carried by a move - a real client batches its pointer samples the same way
+    size_t      speed;//canvas units between two samples
+    size_t      join_per_tick;//a join scans the whole room - spread them so the reactor is not stalled
+    size_t      tick_msec;
+    bool        receive;//also be fanned out to - otherwise the members only send (kept suspended)
+};
+
+//In-process room members for capacity testing.
+//Every member occupies a real ConnectionStub slot of the Engine but has no socket:
+//its moves, along a seeded random-waypoint trajectory, are injected straight into
+//Engine::eventsReceived and what the Engine sends to it is completed right away.
+//Runs on the aio reactor of the Engine - the Engine is never touched from another thread.
+class SyntheticMembers: public solid::Dynamic<SyntheticMembers, solid::frame::aio::Object>{
+public:
+    using PointerT = solid::DynamicPointer<SyntheticMembers>;
+
+    static PointerT create(
+        solid::frame::ServiceT &_rsvc, Engine &_rengine,
+        const SyntheticConfiguration &_rcfg
+    ){
+        return PointerT(new SyntheticMembers(_rsvc, _rengine, _rcfg));
+    }
+
+    //can be called from any thread
+    void plotStatistics(std::ostream &_ros)const;
+private:
+    SyntheticMembers(
+        solid::frame::ServiceT &_rsvc, Engine &_rengine,
+        const SyntheticConfiguration &_rcfg
+    );
+    ~SyntheticMembers();
+
+    void onEvent(solid::frame::aio::ReactorContext &_rctx, solid::Event &&_uevent) override;
+    void onTimer(solid::frame::aio::ReactorContext &_rctx);
+    void doJoin();
+    void doMove();
+    void doCompleteDeliveries();
+    void doStop(solid::frame::aio::ReactorContext &_rctx);
+private:
+    struct Data;
+    Data    &d;
+};
+
+}//namespace server
+}//namespace bubbles
+
+#endif
@@ -0,0 +1,201 @@
+#include "bubbles_server_trace.hpp"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+namespace bubbles{
+namespace server{
+namespace trace{
+
+std::atomic<bool> is_enabled(false);
+
+namespace{
+
+//single producer ring - every slot is a seqlock, odd while being written.
+//The span fields are atomics too, so a dump racing with the owner thread reads
+//torn values at worst - the seq check throws those away - never a data race.
+struct Ring{
+    struct Slot{
+        Slot():seq(0), ptype(nullptr), start_nsec(0), duration_nsec(0), id(0), arg0(0), arg1(0){}
+
+        std::atomic<uint64_t>           seq;
+        std::atomic<const SpanType*>    ptype;
+        std::atomic<uint64_t>           start_nsec;
+        std::atomic<uint64_t>           duration_nsec;
+        std::atomic<uint64_t>           id;
+        std::atomic<uint64_t>           arg0;
+        std::atomic<uint64_t>           arg1;
+    };
+
+    Ring(const size_t _capacity, const size_t _thread_index):slots(_capacity), head(0), thread_index(_thread_index){}
+
+    void push(const Span &_rspan){
+        Slot            &rslot = slots[head % slots.size()];
+        const uint64_t  seq = rslot.seq.load(std::memory_order_relaxed);
+
+        rslot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        rslot.ptype.store(_rspan.ptype, std::memory_order_relaxed);
+        rslot.start_nsec.store(_rspan.start_nsec, std::memory_order_relaxed);
+        rslot.duration_nsec.store(_rspan.duration_nsec, std::memory_order_relaxed);
+        rslot.id.store(_rspan.id, std::memory_order_relaxed);
+        rslot.arg0.store(_rspan.arg0, std::memory_order_relaxed);
+        rslot.arg1.store(_rspan.arg1, std::memory_order_relaxed);
+        rslot.seq.store(seq + 2, std::memory_order_release);
+        ++head;
+    }
+
+    //false if the slot is empty or was being overwritten
+    bool read(const size_t _index, Span &_rspan)const{
+        const Slot      &rslot = slots[_index];
+        const uint64_t  seq = rslot.seq.load(std::memory_order_acquire);
+
+        if(seq == 0 or (seq & 1)){
+            return false;
+        }
+        _rspan.ptype = rslot.ptype.load(std::memory_order_relaxed);
+        _rspan.start_nsec = rslot.start_nsec.load(std::memory_order_relaxed);
+        _rspan.duration_nsec = rslot.duration_nsec.load(std::memory_order_relaxed);
+        _rspan.id = rslot.id.load(std::memory_order_relaxed);
+        _rspan.arg0 = rslot.arg0.load(std::memory_order_relaxed);
+        _rspan.arg1 = rslot.arg1.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return rslot.seq.load(std::memory_order_relaxed) == seq;
+    }
+
+    std::vector<Slot>   slots;
+    size_t              head;//only touched by the owner thread
+    const size_t        thread_index;
+};
+
+using RingPointerT = std::unique_ptr<Ring>;
+
+struct Registry{
+    Registry():capacity(0), sample_every(1), id_seq(0){}
+
+    std::mutex                  mutex;
+    std::vector<RingPointerT>   rings;//never shrinks - a thread's ring outlives the thread
+    size_t                      capacity;
+    size_t                      sample_every;
+    std::atomic<uint64_t>       id_seq;
+};
+
+Registry& registry(){
+    static Registry r;
+    return r;
+}
+
+thread_local Ring   *pthread_ring = nullptr;
+
+Ring& thread_ring(){
+    if(pthread_ring == nullptr){
+        Registry                    &rr = registry();
+        std::lock_guard<std::mutex> lock(rr.mutex);
+
+        rr.rings.emplace_back(new Ring(rr.capacity, rr.rings.size() + 1));
+        pthread_ring = rr.rings.back().get();
+    }
+    return *pthread_ring;
+}
+
+void write_span_head(ostream &_ros, const Span &_rspan, const char _phase, const size_t _thread_index, const uint64_t _ts_nsec){
+    _ros<<"{\"name\":\""<<_rspan.ptype->name<<"\",\"cat\":\"bubbles\",\"ph\":\""<<_phase<<'"';
+    _ros<<",\"pid\":1,\"tid\":"<<_thread_index<<",\"ts\":"<<(_ts_nsec / 1000)<<'.'<<(_ts_nsec % 1000) / 100;
+    if(_rspan.ptype->async){
+        _ros<<",\"id\":\"0x"<<std::hex<<_rspan.id<<std::dec<<'"';
+    }
+}
+
+void write_span_args(ostream &_ros, const Span &_rspan){
+    _ros<<",\"args\":{\"id\":"<<_rspan.id;
+    if(_rspan.ptype->arg0_name){
+        _ros<<",\""<<_rspan.ptype->arg0_name<<"\":"<<_rspan.arg0;
+    }
+    if(_rspan.ptype->arg1_name){
+        _ros<<",\""<<_rspan.ptype->arg1_name<<"\":"<<_rspan.arg1;
+    }
+    _ros<<'}';
+}
+
+}//namespace
+
+void configure(const size_t _capacity, const size_t _sample_every){
+    Registry &rr = registry();
+    {
+        std::lock_guard<std::mutex> lock(rr.mutex);
+        rr.capacity = _capacity;
+        rr.sample_every = _sample_every ? _sample_every : 1;
+    }
+    is_enabled.store(_capacity != 0);
+}
+
+uint64_t nextId(){
+    if(not enabled()){
+        return 0;
+    }
+    Registry        &rr = registry();
+    const uint64_t  seq = rr.id_seq.fetch_add(1, std::memory_order_relaxed);
+
+    return (seq % rr.sample_every) == 0 ? seq / rr.sample_every + 1 : 0;
+}
+
+void record(
+    const SpanType &_rtype, const uint64_t _start_nsec, const uint64_t _end_nsec,
+    const uint64_t _id, const uint64_t _arg0, const uint64_t _arg1
+){
+    if(not enabled()){
+        return;
+    }
+    Span span;
+
+    span.ptype = &_rtype;
+    span.start_nsec = _start_nsec;
+    span.duration_nsec = _end_nsec > _start_nsec ? _end_nsec - _start_nsec : 0;
+    span.id = _id;
+    span.arg0 = _arg0;
+    span.arg1 = _arg1;
+
+    thread_ring().push(span);
+}
+
+void dump(std::ostream &_ros){
+    Registry                    &rr = registry();
+    std::lock_guard<std::mutex> lock(rr.mutex);
+    bool                        first = true;
+
+    _ros<<"{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    for(const auto &rring_ptr: rr.rings){
+        for(size_t i = 0; i < rring_ptr->slots.size(); ++i){
+            Span span;
+
+            if(not rring_ptr->read(i, span)){
+                continue;
+            }
+            if(not first){
+                _ros<<",\n";
+            }
+            first = false;
+
+            if(span.ptype->async){
+                write_span_head(_ros, span, 'b', rring_ptr->thread_index, span.start_nsec);
+                write_span_args(_ros, span);
+                _ros<<"},\n";
+                write_span_head(_ros, span, 'e', rring_ptr->thread_index, span.start_nsec + span.duration_nsec);
+                _ros<<'}';
+            }else{
+                write_span_head(_ros, span, 'X', rring_ptr->thread_index, span.start_nsec);
+                _ros<<",\"dur\":"<<(span.duration_nsec / 1000)<<'.'<<(span.duration_nsec % 1000) / 100;
+                write_span_args(_ros, span);
+                _ros<<'}';
+            }
+        }
+    }
+    _ros<<"\n]}"<<endl;
+}
+
+}//namespace trace
+}//namespace server
+}//namespace bubbles
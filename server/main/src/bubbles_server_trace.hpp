@@ -0,0 +1,65 @@
+#ifndef BUBBLES_SERVER_TRACE_HPP
+#define BUBBLES_SERVER_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace bubbles{
+namespace server{
+namespace trace{
+
+//what a span is - one static instance per kind of span
+struct SpanType{
+    const char  *name;
+    const char  *arg0_name;//nullptr for no argument
+    const char  *arg1_name;
+    bool        async;//spans of this type overlap on the same thread - exported as begin/end pairs
+};
+
+struct Span{
+    Span():ptype(nullptr), start_nsec(0), duration_nsec(0), id(0), arg0(0), arg1(0){}
+
+    const SpanType  *ptype;
+    uint64_t        start_nsec;
+    uint64_t        duration_nsec;
+    uint64_t        id;//links the spans of the same message
+    uint64_t        arg0;
+    uint64_t        arg1;
+};
+
+//Tracing is off until configure is called with a non zero capacity.
+//Every thread that records gets its own ring of _capacity spans: recording
+//takes no lock and allocates nothing after the first span of the thread;
+//the oldest spans are overwritten.
+//_sample_every: only one message in _sample_every gets a trace id - see nextId.
+void configure(const size_t _capacity, const size_t _sample_every = 1);
+
+extern std::atomic<bool> is_enabled;
+
+inline bool enabled(){
+    return is_enabled.load(std::memory_order_relaxed);
+}
+
+inline uint64_t now(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//0 - the message is not traced
+uint64_t nextId();
+
+void record(
+    const SpanType &_rtype, const uint64_t _start_nsec, const uint64_t _end_nsec,
+    const uint64_t _id, const uint64_t _arg0 = 0, const uint64_t _arg1 = 0
+);
+
+//Writes the spans of all threads in Chrome trace event format (chrome://tracing, Perfetto).
+//Can be called from any thread while the others keep recording.
+void dump(std::ostream &_ros);
+
+}//namespace trace
+}//namespace server
+}//namespace bubbles
+
+#endif